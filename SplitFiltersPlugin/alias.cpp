@@ -0,0 +1,874 @@
+#include "alias.h"
+#include "alias_cache.h"
+#include "profiler.h"
+#include "thread_pool.h"
+#include <algorithm>
+#include <cassert>
+#include <charconv>
+#include <cstdint>
+#include <map>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(_M_X64) || defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+/// ビットマスクの最下位の立っているビット位置を返す
+static int lowest_bit_index(uint64_t mask) {
+#if defined(_MSC_VER)
+	unsigned long index;
+	_BitScanForward64(&index, mask);
+	return (int)index;
+#else
+	return __builtin_ctzll(mask);
+#endif
+}
+
+
+#if defined(__AVX2__)
+/// 64 バイト中の '\n' の位置をビットマスクで返す (AVX2)
+static uint64_t newline_mask64(const char* p) {
+	const __m256i nl = _mm256_set1_epi8('\n');
+	uint64_t lo = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*)p), nl));
+	uint64_t hi = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*)(p + 32)), nl));
+	return lo | (hi << 32);
+}
+#elif defined(_M_X64) || defined(__SSE2__)
+/// 64 バイト中の '\n' の位置をビットマスクで返す (SSE2)
+static uint64_t newline_mask64(const char* p) {
+	const __m128i nl = _mm_set1_epi8('\n');
+	uint64_t m0 = (uint16_t)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)p), nl));
+	uint64_t m1 = (uint16_t)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(p + 16)), nl));
+	uint64_t m2 = (uint16_t)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(p + 32)), nl));
+	uint64_t m3 = (uint16_t)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(p + 48)), nl));
+	return m0 | (m1 << 16) | (m2 << 32) | (m3 << 48);
+}
+#endif
+
+
+/// [begin, end) の各行について on_line(行頭, '\n' の位置) を呼び出す
+/// '\n' の検出は SSE2 / AVX2 で 64 バイトずつまとめて行う（使えない環境ではスカラー）
+template <typename F>
+static void for_each_line(const char* begin, const char* end, F&& on_line) {
+	const char* line_start = begin;
+	const char* p = begin;
+#if defined(__AVX2__) || defined(_M_X64) || defined(__SSE2__)
+	for (; end - p >= 64; p += 64) {
+		uint64_t mask = newline_mask64(p);
+		while (mask) {
+			const char* nl = p + lowest_bit_index(mask);
+			on_line(line_start, nl);
+			line_start = nl + 1;
+			mask &= mask - 1;
+		}
+	}
+#endif
+	// 残り（または SIMD が使えない環境）はスカラーで探す
+	for (; p < end; p++) {
+		if (*p == '\n') {
+			on_line(line_start, p);
+			line_start = p + 1;
+		}
+	}
+	// 改行で終わっていない最終行
+	if (line_start < end) {
+		on_line(line_start, end);
+	}
+}
+
+
+/// 行が [Object.x] であれば x を取り出す
+/// @param line 行の文字列 (改行を含まない)
+/// @param index [out] x の値
+/// @param bracket_end [out] ']' の位置
+/// @return [Object.x] の行であれば true (x が数字だけでなければ本文の行とみなして false)
+static bool parse_section_line(std::string_view line, int& index, size_t& bracket_end) {
+	const std::string_view prefix = "[Object.";
+	if (line.size() <= prefix.size() || line.compare(0, prefix.size(), prefix) != 0) return false;
+
+	bracket_end = line.find(']', prefix.size());
+	if (bracket_end == std::string_view::npos) return false;
+
+	const char* last = line.data() + bracket_end;
+	auto result = std::from_chars(line.data() + prefix.size(), last, index);
+	return result.ec == std::errc() && result.ptr == last;
+}
+
+
+/// [Object] ヘッダと [Object.x] を一度の走査で展開する
+/// 行単位で走査し、CRLF / LF のどちらの改行にも対応する
+/// @param alias エイリアスデータ
+/// @return 解析済みのエイリアス (alias を参照する)
+ParsedAlias parse_alias(std::string_view alias) {
+	ParsedAlias out;
+
+	const std::string_view header_key = "[Object]";
+	const std::string_view effect_key = "effect.name=";
+
+	const char* begin = alias.data();
+	const char* end = begin + alias.size();
+	const char* header_start = nullptr;
+	ObjSec* cur = nullptr;
+
+	for_each_line(begin, end, [&](const char* line_start, const char* nl) {
+		// 行末の \r は値に含めない
+		const char* line_end = nl;
+		if (line_end > line_start && line_end[-1] == '\r') line_end--;
+		std::string_view line(line_start, line_end - line_start);
+		if (line.empty()) return;
+
+		int index;
+		size_t bracket_end;
+		if (line[0] == '[') {
+			if (parse_section_line(line, index, bracket_end) && (cur || index == 0)) {
+				// 直前のセクションをこの行の手前で閉じる
+				size_t pos = line_start - begin;
+				if (cur) {
+					cur->sec = alias.substr(cur->sec.data() - begin, line_start - cur->sec.data());
+					cur->body = alias.substr(cur->body.data() - begin, line_start - cur->body.data());
+				}
+				else if (header_start) {
+					// [Object] ～ [Object.0] の直前までをヘッダとする
+					out.header = alias.substr(header_start - begin, line_start - header_start);
+				}
+
+				ObjSec sec;
+				sec.sec = alias.substr(pos);
+				sec.body = alias.substr(pos + bracket_end + 1);
+				sec.index = index;
+				sec.effect_id = EffectId::UNKNOWN;
+				out.objs.push_back(sec);
+				cur = &out.objs.back();
+			}
+			else if (!cur && !header_start && line == header_key) {
+				header_start = line_start;
+			}
+		}
+		else if (cur && cur->effect_name.empty() && line[0] == 'e' && line.compare(0, effect_key.size(), effect_key) == 0) {
+			// effect.name の値を抽出
+			cur->effect_name = line.substr(effect_key.size());
+			cur->effect_id = lookup_effect_id(cur->effect_name);
+		}
+	});
+
+	return out;
+}
+
+
+/// フィルタ効果の開始インデックスを計算
+/// @param objs 解析済みの ObjSec ベクター
+/// @param include_self_filter 自身のフィルタ効果を対象にするか
+/// @return 2 または 1
+int calc_start_index(const std::vector<ObjSec>& objs, bool include_self_filter) {
+	if (include_self_filter) {
+		if (has_output_section(objs)) {
+			// 出力切り替えセクションがある場合、フィルタ効果は[Object.2]以降
+			return 2;
+		}
+		else if (is_none_output_object(objs)){
+			// 特殊メディアオブジェクトかフィルタオブジェクトの場合、フィルタ効果は[Object.1]以降
+			return 1;
+		}
+		else {
+			// それ以外(フィルタ効果)は[Object.0]以降
+			return 0;
+		}
+	}
+	else {
+		// フィルタオブジェクトなら、追加フィルタ効果は[Object.2]以降
+		if (has_effect_category(objs[0].effect_id, EFFECT_FILTER_OBJECT)) return 2;
+
+		// 自身のフィルタ効果を対象にしない場合、追加フィルタ効果は[Object.1] (+出力切り替えセクション) 以降
+		return 1 + has_output_section(objs);
+	}
+}
+
+
+/// 出力切り替えセクションがあるかを判定
+/// @param objs 解析済みの ObjSec ベクター
+/// @return true/false
+bool has_output_section(const std::vector<ObjSec>& objs) {
+	return objs.size() >= 2 && has_effect_category(objs[1].effect_id, EFFECT_OUTPUT_SECTION);
+}
+
+
+/// 特殊メディアオブジェクトか判定 (グループ制御や部分フィルタなど、出力切り替えセクションを持たないもの)
+/// @param objs 解析済みの ObjSec ベクター
+/// @return true/false
+bool is_none_output_object(const std::vector<ObjSec>& objs) {
+	return !objs.empty() && has_effect_category(objs[0].effect_id, EFFECT_NON_OUTPUT_OBJECT);
+}
+
+
+/// セクションの本文から key=value の索引を作成する
+/// 同じ key が複数あれば最初のものを使う (effect.name の抽出と同じ)
+static void index_section_params(std::string_view body, SectionParams& params) {
+	for_each_line(body.data(), body.data() + body.size(), [&](const char* line_start, const char* nl) {
+		const char* line_end = nl;
+		if (line_end > line_start && line_end[-1] == '\r') line_end--;
+		std::string_view line(line_start, line_end - line_start);
+		size_t eq = line.find('=');
+		if (eq == std::string_view::npos || eq == 0) return;
+		params.emplace(line.substr(0, eq), line.substr(eq + 1));
+	});
+}
+
+
+const SectionParams& AliasModel::params(size_t section) const {
+	static const SectionParams empty;
+	if (section >= parsed.objs.size()) return empty;
+
+	std::call_once(index_once, [&] {
+		index.reset(new SectionIndex[parsed.objs.size()]);
+	});
+	SectionIndex& entry = index[section];
+	std::call_once(entry.once, [&] {
+		index_section_params(parsed.objs[section].body, entry.params);
+	});
+	return entry.params;
+}
+
+
+std::string_view AliasModel::param(size_t section, std::string_view key) const {
+	const auto& p = params(section);
+	auto it = p.find(key);
+	return it != p.end() ? it->second : std::string_view();
+}
+
+
+/// UTF-8 の先頭バイトから1文字のバイト数を返す
+static size_t utf8_char_size(unsigned char c) {
+	return c < 0x80 ? 1 : c < 0xE0 ? 2 : c < 0xF0 ? 3 : 4;
+}
+
+
+/// ワイルドカード (* / ?) を含むパターンに文字列が一致するか
+/// ? と * の読み飛ばしは UTF-8 の1文字単位で行う
+static bool glob_match(std::string_view pattern, std::string_view text) {
+	size_t p = 0, t = 0;
+	size_t star = std::string_view::npos;	// 直前の * の次のパターン位置
+	size_t star_text = 0;					// 直前の * に対応させ始めた文字列の位置
+	while (t < text.size()) {
+		if (p < pattern.size() && pattern[p] == '*') {
+			star = ++p;
+			star_text = t;
+		}
+		else if (p < pattern.size() && pattern[p] == '?') {
+			p++;
+			t += utf8_char_size(text[t]);
+		}
+		else if (p < pattern.size() && pattern[p] == text[t]) {
+			p++;
+			t++;
+		}
+		else if (star != std::string_view::npos) {
+			// * に対応させる範囲を1文字広げてやり直す
+			p = star;
+			star_text += utf8_char_size(text[star_text]);
+			t = star_text;
+		}
+		else {
+			return false;
+		}
+	}
+	while (p < pattern.size() && pattern[p] == '*') p++;
+	return p == pattern.size();
+}
+
+
+EffectNameFilter::EffectNameFilter(std::string_view patterns)
+	: source(std::make_shared<const std::string>(patterns)) {
+	const std::string_view all = *source;
+	const std::string_view spaces = " \t\r\n";
+	size_t pos = 0;
+	while (pos <= all.size()) {
+		size_t next = all.find(';', pos);
+		if (next == std::string_view::npos) next = all.size();
+		std::string_view pattern = all.substr(pos, next - pos);
+		pos = next + 1;
+
+		size_t first = pattern.find_first_not_of(spaces);
+		if (first == std::string_view::npos) continue;
+		pattern = pattern.substr(first, pattern.find_last_not_of(spaces) - first + 1);
+
+		if (pattern.find_first_of("*?") == std::string_view::npos) {
+			names.insert(pattern);
+		}
+		else {
+			globs.push_back(pattern);
+		}
+	}
+}
+
+
+bool EffectNameFilter::matches(std::string_view effect_name) const {
+	if (names.count(effect_name)) return true;
+	for (const auto& glob : globs) {
+		if (glob_match(glob, effect_name)) return true;
+	}
+	return false;
+}
+
+
+/// 10進数の桁数を返す
+static size_t count_digits(int value) {
+	size_t n = 1;
+	while (value >= 10) {
+		value /= 10;
+		n++;
+	}
+	return n;
+}
+
+
+void AliasBuilder::add_part(const Part& part) {
+	if (part_num < MAX_PARTS) {
+		parts[part_num++] = part;
+		return;
+	}
+	if (more_parts.empty()) more_parts.assign(parts, parts + MAX_PARTS);
+	more_parts.push_back(part);
+	part_num++;
+}
+
+
+AliasBuilder& AliasBuilder::append(std::string_view text) {
+	add_part({ text, nullptr, 0, 0, 0 });
+	return *this;
+}
+
+
+AliasBuilder& AliasBuilder::append_sections(const std::vector<ObjSec>& objs, int first_index, int last_index, int base_index) {
+	if (last_index > (int)objs.size()) last_index = (int)objs.size();
+	if (first_index < last_index) {
+		add_part({ {}, &objs, first_index, last_index, base_index });
+	}
+	return *this;
+}
+
+
+std::string AliasBuilder::build() const {
+	static const std::string_view sec_prefix = "[Object.";
+
+	// 出力サイズを計算
+	size_t size = 0;
+	for (int p = 0; p < part_num; p++) {
+		const Part& part = part_at(p);
+		if (!part.objs) {
+			size += part.text.size();
+			continue;
+		}
+		int new_idx = part.base_index;
+		for (int i = part.first_index; i < part.last_index; i++) {
+			size += sec_prefix.size() + count_digits(new_idx++) + 1 + (*part.objs)[i].body.size();
+		}
+	}
+
+	// 一度だけ確保して書き出す
+	std::string result(size, '\0');
+	char* out = result.data();
+	for (int p = 0; p < part_num; p++) {
+		const Part& part = part_at(p);
+		if (!part.objs) {
+			out = std::copy(part.text.begin(), part.text.end(), out);
+			continue;
+		}
+		int new_idx = part.base_index;
+		for (int i = part.first_index; i < part.last_index; i++) {
+			const ObjSec& sec = (*part.objs)[i];
+			out = std::copy(sec_prefix.begin(), sec_prefix.end(), out);
+			out = std::to_chars(out, result.data() + size, new_idx++).ptr;
+			*out++ = ']';
+			out = std::copy(sec.body.begin(), sec.body.end(), out);
+		}
+	}
+	return result;
+}
+
+
+/// 部品ごとの解析結果からエイリアスデータの AliasModel を作成する
+/// [Object.x] セクションの部品は元の ObjSec の位置をずらすだけで、解析し直さない
+/// 先頭以外に文字列の部品がある場合や、セクションが行頭から始まらない場合は全体を解析する
+std::shared_ptr<const AliasModel> AliasBuilder::build_model() const {
+	static const std::string_view sec_prefix = "[Object.";
+
+	auto model = std::make_shared<AliasModel>();
+	model->alias = std::make_shared<const std::string>(build());
+	const std::string_view out = *model->alias;
+
+	// 先頭の文字列の部品 (ヘッダや GROUP_OBJ0 など) は短いので、その範囲だけ解析する
+	int p = 0;
+	size_t pos = 0;
+	while (p < part_num && !part_at(p).objs) pos += part_at(p++).text.size();
+	const std::string_view preamble = out.substr(0, pos);
+	ParsedAlias& parsed = model->parsed;
+	parsed = parse_alias(preamble);
+	if (parsed.objs.empty()) {
+		// セクションがなければ、[Object] の行から文字列の部品の終わりまでをヘッダとする
+		for (size_t h = preamble.find("[Object]"); h != std::string_view::npos; h = preamble.find("[Object]", h + 1)) {
+			if (h == 0 || preamble[h - 1] == '\n') {
+				parsed.header = preamble.substr(h);
+				break;
+			}
+		}
+	}
+
+	size_t section_num = parsed.objs.size();
+	for (int q = p; q < part_num; q++) {
+		if (part_at(q).objs) section_num += part_at(q).last_index - part_at(q).first_index;
+	}
+	parsed.objs.reserve(section_num);
+
+	bool structural = true;
+	for (; p < part_num && structural; p++) {
+		const Part& part = part_at(p);
+		if (!part.objs) {
+			structural = false;
+			break;
+		}
+		for (int i = part.first_index; i < part.last_index; i++) {
+			const ObjSec& src = (*part.objs)[i];
+			const int new_idx = part.base_index + (i - part.first_index);
+			const size_t head_size = sec_prefix.size() + count_digits(new_idx) + 1;
+
+			// 行頭から始まらないセクションや、[Object.0] 以外から始まるセクションは解析結果が変わる
+			if ((pos > 0 && out[pos - 1] != '\n') || (parsed.objs.empty() && new_idx != 0)) {
+				structural = false;
+				break;
+			}
+
+			ObjSec sec;
+			sec.sec = out.substr(pos, head_size + src.body.size());
+			sec.body = sec.sec.substr(head_size);
+			sec.index = new_idx;
+			sec.effect_name = src.effect_name.empty() ? std::string_view() : sec.body.substr(src.effect_name.data() - src.body.data(), src.effect_name.size());
+			sec.effect_id = src.effect_id;
+			parsed.objs.push_back(sec);
+			pos += sec.sec.size();
+		}
+	}
+	if (parsed.objs.empty()) {
+		// parse_alias と同じく、セクションがなければヘッダも空にする
+		parsed.header = {};
+	}
+	if (!structural) {
+		ProfileSpan span(ProfileEvent::PARSE);
+		parsed = parse_alias(out);
+		profile_count(ProfileCounter::BYTES_PARSED, out.size());
+	}
+	return model;
+}
+
+
+/// 組み立てたエイリアスデータを解析済みキャッシュの追加待ちにして返す
+/// 作成したオブジェクトのエイリアスを次のコマンドで再解析しないようにする
+/// (返すエイリアスはキャッシュと共有し、コピーしない。キャッシュへの追加はコマンドの終了時に行う)
+static std::shared_ptr<const std::string> build_and_seed(const AliasBuilder& builder) {
+	auto model = builder.build_model();
+	alias_cache().stage(model);
+	return model->alias;
+}
+
+
+/// 作成できない場合に返す空のエイリアス
+static std::shared_ptr<const std::string> empty_alias() {
+	static const auto empty = std::make_shared<const std::string>();
+	return empty;
+}
+
+
+const ParsedAlias& SplitPlan::parsed() const {
+	static const ParsedAlias empty;
+	return model ? model->parsed : empty;
+}
+
+
+/// エイリアスを解析し、コマンド内で共有する SplitPlan を作成
+/// 同じ内容のエイリアスを解析済みであれば、キャッシュの解析結果を使う
+/// 解析したものはキャッシュの追加待ちにする (AliasCache::flush_staged で追加される)
+/// ホストを呼び出さないため、複数スレッドから同時に呼び出してよい
+/// @param alias: エイリアスデータ
+/// @param include_self_filter: 自身のフィルタ効果を対象にするか (calc_start_index を参照)
+/// @return 解析済みの SplitPlan
+SplitPlan make_split_plan(std::shared_ptr<const std::string> alias, bool include_self_filter) {
+	if (!alias) alias = std::make_shared<const std::string>();
+
+	SplitPlan plan;
+	plan.model = alias_cache().find(*alias);
+	if (!plan.model) {
+		auto model = std::make_shared<AliasModel>();
+		model->alias = std::move(alias);
+		{
+			ProfileSpan span(ProfileEvent::PARSE);
+			model->parsed = parse_alias(*model->alias);
+		}
+		profile_count(ProfileCounter::BYTES_PARSED, model->alias->size());
+		alias_cache().stage(model);
+		plan.model = std::move(model);
+	}
+
+	const auto& objs = plan.parsed().objs;
+	plan.start_index = objs.empty() ? 0 : calc_start_index(objs, include_self_filter);
+	plan.is_filter_object = !objs.empty() && has_effect_category(objs[0].effect_id, EFFECT_FILTER_OBJECT);
+	return plan;
+}
+
+
+/// objs[first_index]～objs[last_index - 1] のフィルタ効果で、フィルタ効果オブジェクトを作成
+/// 元がフィルタオブジェクトならフィルタオブジェクトとして、それ以外はフィルタ効果として作成する
+static std::shared_ptr<const std::string> build_filter_range_alias(const SplitPlan& plan, int first_index, int last_index) {
+	ProfileSpan span(ProfileEvent::BUILD);
+	const auto& objs = plan.parsed().objs;
+	if (objs.empty()) return empty_alias();
+
+	// 再構築 [Object]～[Object.0]～[Object.n]
+	AliasBuilder builder;
+	builder.append(plan.parsed().header);
+	if (plan.is_filter_object) {
+		builder.append(FILTER_OBJECT_OBJ0).append_sections(objs, first_index, last_index, 1);
+	}
+	else {
+		builder.append_sections(objs, first_index, last_index, 0);
+	}
+	return build_and_seed(builder);
+}
+
+
+/// エイリアスに付くフィルタを抽出して、フィルタ効果オブジェクトを作成
+/// @param plan: 解析済みの SplitPlan
+/// @return フィルタ効果オブジェクトのエイリアスデータ
+std::shared_ptr<const std::string> build_target_alias(const SplitPlan& plan) {
+	return build_filter_range_alias(plan, plan.start_index, (int)plan.parsed().objs.size());
+}
+
+
+/// エイリアスに付くフィルタを1つだけ抽出して、フィルタ効果オブジェクトを作成
+/// @param plan: 解析済みの SplitPlan
+/// @param filter_index: 抽出するフィルタ効果 (0 ～ filter_count() - 1)
+/// @return フィルタ効果オブジェクトのエイリアスデータ
+std::shared_ptr<const std::string> build_single_filter_alias(const SplitPlan& plan, int filter_index) {
+	const int index = plan.start_index + filter_index;
+	return build_filter_range_alias(plan, index, index + 1);
+}
+
+
+/// 追加フィルタ効果のうち、エフェクト名が一致するものを探す
+/// @param plan: 解析済みの SplitPlan
+/// @param filter: エフェクト名の一致条件
+/// @return 一致したセクションの objs の添字 (昇順)
+std::vector<int> find_matching_filters(const SplitPlan& plan, const EffectNameFilter& filter) {
+	const auto& objs = plan.parsed().objs;
+	std::vector<int> indices;
+	for (int i = plan.start_index; i < (int)objs.size(); i++) {
+		if (filter.matches(objs[i].effect_name)) indices.push_back(i);
+	}
+	return indices;
+}
+
+
+/// objs のうち indices (昇順) のセクションを、連続する範囲ごとにまとめて [Object.base_index] から振り直して追加する
+static void append_selected_sections(AliasBuilder& builder, const std::vector<ObjSec>& objs, const std::vector<int>& indices, int base_index) {
+	size_t k = 0;
+	while (k < indices.size()) {
+		size_t run_end = k + 1;
+		while (run_end < indices.size() && indices[run_end] == indices[run_end - 1] + 1) run_end++;
+		builder.append_sections(objs, indices[k], indices[run_end - 1] + 1, base_index);
+		base_index += (int)(run_end - k);
+		k = run_end;
+	}
+}
+
+
+/// 指定した追加フィルタ効果だけを抽出して、フィルタ効果オブジェクトを作成
+/// @param plan: 解析済みの SplitPlan
+/// @param indices: 抽出するセクションの objs の添字 (昇順、find_matching_filters の結果)
+/// @return フィルタ効果オブジェクトのエイリアスデータ
+std::shared_ptr<const std::string> build_selected_filters_alias(const SplitPlan& plan, const std::vector<int>& indices) {
+	ProfileSpan span(ProfileEvent::BUILD);
+	const auto& objs = plan.parsed().objs;
+	if (objs.empty() || indices.empty()) return empty_alias();
+
+	AliasBuilder builder;
+	builder.append(plan.parsed().header);
+	if (plan.is_filter_object) {
+		builder.append(FILTER_OBJECT_OBJ0);
+		append_selected_sections(builder, objs, indices, 1);
+	}
+	else {
+		append_selected_sections(builder, objs, indices, 0);
+	}
+	return build_and_seed(builder);
+}
+
+
+/// 元オブジェクトから指定した追加フィルタ効果を取り除いたものを作成
+/// @param plan: 解析済みの SplitPlan
+/// @param indices: 取り除くセクションの objs の添字 (昇順、find_matching_filters の結果)
+std::shared_ptr<const std::string> build_unselected_alias(const SplitPlan& plan, const std::vector<int>& indices) {
+	ProfileSpan span(ProfileEvent::BUILD);
+	const auto& objs = plan.parsed().objs;
+	if (objs.empty()) return empty_alias();
+
+	// 残すフィルタ効果の添字
+	std::vector<int> remaining;
+	size_t k = 0;
+	for (int i = plan.start_index; i < (int)objs.size(); i++) {
+		if (k < indices.size() && indices[k] == i) {
+			k++;
+			continue;
+		}
+		remaining.push_back(i);
+	}
+
+	// [Object] + [Object.0] ～ フィルタ効果の開始地点まで + 残りのフィルタ効果
+	AliasBuilder builder;
+	builder.append(plan.parsed().header).append_sections(objs, 0, plan.start_index, 0);
+	append_selected_sections(builder, objs, remaining, plan.start_index);
+	return build_and_seed(builder);
+}
+
+
+/// エイリアスに付くフィルタを抽出して、グループ制御オブジェクトを作成
+/// @param plan: 解析済みの SplitPlan
+/// @param audio: グループ制御(音声) にするか
+/// @return グループ制御オブジェクトのエイリアスデータ
+std::shared_ptr<const std::string> build_group_alias(const SplitPlan& plan, bool audio) {
+	ProfileSpan span(ProfileEvent::BUILD);
+	const auto& objs = plan.parsed().objs;
+	if (objs.empty()) return empty_alias();
+
+	// 再構築 [Object]～[Object.0] (グループ制御)～[Object.1]～[Object.n]
+	return build_and_seed(AliasBuilder()
+		.append(plan.parsed().header)
+		.append(audio ? GROUP_AUDIO_OBJ0 : GROUP_OBJ0)
+		.append_sections(objs, plan.start_index, (int)objs.size(), 1));
+}
+
+
+/// エイリアスに付く末尾のフィルタを抽出して、複数レイヤーを対象にするグループ制御オブジェクトを作成
+/// グループ制御のフィルタ効果は各オブジェクトのフィルタ効果の後に掛かるため、共有するのは末尾のフィルタ効果にする
+/// @param plan: 解析済みの SplitPlan (末尾のフィルタ効果を共有するオブジェクトのうちの1つ)
+/// @param filter_count: グループ制御に移すフィルタ効果の数
+/// @param layer_count: 対象レイヤー数
+/// @param audio: グループ制御(音声) にするか
+/// @return グループ制御オブジェクトのエイリアスデータ
+std::shared_ptr<const std::string> build_shared_group_alias(const SplitPlan& plan, int filter_count, int layer_count, bool audio) {
+	ProfileSpan span(ProfileEvent::BUILD);
+	const auto& objs = plan.parsed().objs;
+	if (objs.empty()) return empty_alias();
+
+	// [Object.0] の対象レイヤー数を書き換える
+	std::string obj0 = audio ? GROUP_AUDIO_OBJ0 : GROUP_OBJ0;
+	const std::string_view key = "対象レイヤー数=";
+	size_t pos = obj0.find(key);
+	if (pos != std::string::npos) {
+		pos += key.size();
+		obj0.replace(pos, obj0.find('\n', pos) - pos, std::to_string(layer_count));
+	}
+
+	// 再構築 [Object]～[Object.0] (グループ制御)～[Object.1]～[Object.filter_count]
+	return build_and_seed(AliasBuilder()
+		.append(plan.parsed().header)
+		.append(obj0)
+		.append_sections(objs, (int)objs.size() - filter_count, (int)objs.size(), 1));
+}
+
+
+/// フィルタ効果のセクション本文を、末尾の改行を除いて返す
+/// (最後のセクションは改行で終わらないことがあるため、改行の有無で別物と判定しないようにする)
+static std::string_view filter_section_text(const ObjSec& sec) {
+	std::string_view body = sec.body;
+	while (!body.empty() && (body.back() == '\n' || body.back() == '\r')) body.remove_suffix(1);
+	return body;
+}
+
+
+/// 追加フィルタ効果のセクションごとのハッシュ値を求める (FNV-1a)
+/// 並列処理の中で求めておき、common_filter_suffix で使う
+/// @param plan: 解析済みの SplitPlan
+/// @return 追加フィルタ効果の順のハッシュ値
+std::vector<uint64_t> hash_filter_sections(const SplitPlan& plan) {
+	const auto& objs = plan.parsed().objs;
+	std::vector<uint64_t> hashes;
+	hashes.reserve(plan.has_filters() ? plan.filter_count() : 0);
+	for (int i = plan.start_index; i < (int)objs.size(); i++) {
+		uint64_t h = 14695981039346656037ull;
+		for (unsigned char c : filter_section_text(objs[i])) {
+			h = (h ^ c) * 1099511628211ull;
+		}
+		hashes.push_back(h);
+	}
+	return hashes;
+}
+
+
+/// 2つのオブジェクトで、末尾から同じ内容の追加フィルタ効果がいくつ続くかを求める
+/// ハッシュ値が一致したセクションは本文も比較する
+/// @param a, b: 解析済みの SplitPlan
+/// @param a_hashes, b_hashes: hash_filter_sections の結果
+/// @return 共通の追加フィルタ効果の数
+int common_filter_suffix(const SplitPlan& a, const std::vector<uint64_t>& a_hashes, const SplitPlan& b, const std::vector<uint64_t>& b_hashes) {
+	const size_t n = std::min(a_hashes.size(), b_hashes.size());
+	const auto& a_objs = a.parsed().objs;
+	const auto& b_objs = b.parsed().objs;
+	size_t i = 0;
+	while (i < n && a_hashes[a_hashes.size() - 1 - i] == b_hashes[b_hashes.size() - 1 - i]
+		&& filter_section_text(a_objs[a_objs.size() - 1 - i]) == filter_section_text(b_objs[b_objs.size() - 1 - i])) {
+		i++;
+	}
+	return (int)i;
+}
+
+
+/// ホストの結果から学習した、エフェクト名ごとの映像/音声の判定
+/// 更新はホストを呼び出すスレッドから parallel_for の外でのみ行う (並列処理中は参照のみ、learn_media_kind で確かめる)
+/// std::less<> で string_view のまま引けるようにし、参照ごとに std::string を作成しない
+static std::map<std::string, MediaKind, std::less<>> g_learned_media_kind;
+
+
+/// エフェクト名から学習済みの判定を返す
+MediaKind lookup_media_kind(std::string_view effect_name) {
+	if (effect_name.empty()) return MediaKind::UNKNOWN;
+	auto it = g_learned_media_kind.find(effect_name);
+	return it != g_learned_media_kind.end() ? it->second : MediaKind::UNKNOWN;
+}
+
+
+/// オブジェクトが映像と音声のどちらを扱うかを判定する
+/// 出力切り替えセクション → [Object.0] → フィルタ効果 の順に判定し、判定できなければ UNKNOWN
+/// @param plan: 解析済みの SplitPlan
+MediaKind classify_media_kind(const SplitPlan& plan) {
+	const auto& objs = plan.parsed().objs;
+	if (objs.empty()) return MediaKind::UNKNOWN;
+
+	// 出力切り替えセクションがあれば、その種類で決まる
+	if (has_output_section(objs)) {
+		return has_effect_category(objs[1].effect_id, EFFECT_AUDIO) ? MediaKind::AUDIO : MediaKind::VIDEO;
+	}
+
+	if (is_none_output_object(objs) && has_effect_category(objs[0].effect_id, EFFECT_AUDIO)) return MediaKind::AUDIO;
+
+	// フィルタ効果の種類は、これまでのホストの結果から判定する
+	MediaKind kind = lookup_media_kind(objs[0].effect_name);
+	for (size_t i = plan.start_index; kind == MediaKind::UNKNOWN && i < objs.size(); i++) {
+		kind = lookup_media_kind(objs[i].effect_name);
+	}
+	return kind;
+}
+
+
+/// ホストの結果から判明した映像/音声の種類を、含まれるフィルタ効果名ごとに記録する
+/// @param plan: 解析済みの SplitPlan
+/// @param kind: 判明した種類
+void learn_media_kind(const SplitPlan& plan, MediaKind kind) {
+	// 並列処理中の参照と競合しないよう、parallel_for の中からは呼び出さない
+	assert(!in_parallel_for());
+	const auto& objs = plan.parsed().objs;
+	if (objs.empty() || kind == MediaKind::UNKNOWN) return;
+
+	// 出力切り替えセクションを持つオブジェクトは、フィルタ効果以外の名前を記録しない
+	size_t first = has_output_section(objs) || is_none_output_object(objs) ? plan.start_index : 0;
+	for (size_t i = first; i < objs.size(); i++) {
+		if (objs[i].effect_name.empty() || g_learned_media_kind.find(objs[i].effect_name) != g_learned_media_kind.end()) continue;
+		g_learned_media_kind.emplace(std::string(objs[i].effect_name), kind);
+	}
+}
+
+
+/// 元オブジェクトから分離フィルタを削除したものを作成
+/// @param plan: 解析済みの SplitPlan
+std::shared_ptr<const std::string> build_source_alias(const SplitPlan& plan) {
+	return build_remaining_alias(plan, plan.filter_count());
+}
+
+
+/// 元オブジェクトから先頭のフィルタ効果を filter_count 個取り除いたものを作成
+/// @param plan: 解析済みの SplitPlan
+/// @param filter_count: 取り除くフィルタ効果の数
+std::shared_ptr<const std::string> build_remaining_alias(const SplitPlan& plan, int filter_count) {
+	ProfileSpan span(ProfileEvent::BUILD);
+	const auto& objs = plan.parsed().objs;
+	if (objs.empty()) return empty_alias();
+
+	// [Object] + [Object.0] ～ フィルタ効果の開始地点まで + 残りのフィルタ効果
+	const int removed_end = plan.start_index + filter_count;
+	return build_and_seed(AliasBuilder()
+		.append(plan.parsed().header)
+		.append_sections(objs, 0, plan.start_index, 0)
+		.append_sections(objs, removed_end, (int)objs.size(), plan.start_index));
+}
+
+
+/// 元オブジェクトから末尾のフィルタ効果を filter_count 個取り除いたものを作成
+/// @param plan: 解析済みの SplitPlan
+/// @param filter_count: 取り除くフィルタ効果の数
+std::shared_ptr<const std::string> build_leading_filters_alias(const SplitPlan& plan, int filter_count) {
+	ProfileSpan span(ProfileEvent::BUILD);
+	const auto& objs = plan.parsed().objs;
+	if (objs.empty()) return empty_alias();
+
+	// [Object] + [Object.0] ～ 末尾の filter_count 個の手前まで
+	return build_and_seed(AliasBuilder()
+		.append(plan.parsed().header)
+		.append_sections(objs, 0, (int)objs.size() - filter_count, 0));
+}
+
+
+/// 結合先オブジェクトに、結合元の先頭のフィルタ効果を filter_count 個追加したものを作成
+/// @param dest: 結合先の SplitPlan
+/// @param src: 結合元の SplitPlan
+/// @param filter_count: 追加するフィルタ効果の数
+std::shared_ptr<const std::string> build_merged_alias(const SplitPlan& dest, const SplitPlan& src, int filter_count) {
+	ProfileSpan span(ProfileEvent::BUILD);
+	const auto& dest_objs = dest.parsed().objs;
+	const auto& src_objs = src.parsed().objs;
+	return build_and_seed(AliasBuilder()
+		.append(dest.parsed().header)
+		.append_sections(dest_objs, 0, (int)dest_objs.size(), 0)
+		.append_sections(src_objs, src.start_index, src.start_index + filter_count, (int)dest_objs.size()));
+}
+
+
+/// 結合先オブジェクトの追加フィルタ効果を、結合元の追加フィルタ効果すべてで置き換えたものを作成
+/// 結合元のセクションは解析済みの本文をそのまま使い、[Object.x] の番号だけを振り直す
+/// @param dest: 結合先の SplitPlan
+/// @param src: 結合元の SplitPlan
+std::shared_ptr<const std::string> build_replaced_filters_alias(const SplitPlan& dest, const SplitPlan& src) {
+	ProfileSpan span(ProfileEvent::BUILD);
+	const auto& dest_objs = dest.parsed().objs;
+	const auto& src_objs = src.parsed().objs;
+	if (dest_objs.empty()) return empty_alias();
+
+	// [Object] + [Object.0] ～ フィルタ効果の開始地点まで + 結合元のフィルタ効果
+	return build_and_seed(AliasBuilder()
+		.append(dest.parsed().header)
+		.append_sections(dest_objs, 0, dest.start_index, 0)
+		.append_sections(src_objs, src.start_index, (int)src_objs.size(), dest.start_index));
+}
+
+
+/// 縦に並んだフィルタ効果オブジェクトのフィルタ効果を、上から順に1つにまとめたものを作成
+/// @param plans: 上のレイヤーから順に並べた SplitPlan (先頭のヘッダと [Object.0] 以降をそのまま使う)
+/// @return まとめたオブジェクトのエイリアスデータ
+std::shared_ptr<const std::string> build_collapsed_alias(const std::vector<const SplitPlan*>& plans) {
+	ProfileSpan span(ProfileEvent::BUILD);
+	if (plans.empty()) return empty_alias();
+
+	// [Object] + 先頭のオブジェクトのセクションすべて + 2つ目以降のフィルタ効果
+	const SplitPlan& top = *plans[0];
+	const auto& top_objs = top.parsed().objs;
+	AliasBuilder builder;
+	builder.append(top.parsed().header).append_sections(top_objs, 0, (int)top_objs.size(), 0);
+
+	int next_index = (int)top_objs.size();
+	for (size_t i = 1; i < plans.size(); i++) {
+		const SplitPlan& plan = *plans[i];
+		if (!plan.has_filters()) continue;
+		builder.append_sections(plan.parsed().objs, plan.start_index, (int)plan.parsed().objs.size(), next_index);
+		next_index += plan.filter_count();
+	}
+	return build_and_seed(builder);
+}
@@ -0,0 +1,181 @@
+#pragma once
+#include "effect_registry.h"
+#include <vector>
+#include <string>
+#include <string_view>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+
+// エイリアスデータの解析・組み立て
+// ホスト (windows.h / plugin2.h) に依存しないため、プラグイン外でも単体でビルドできる
+
+// --- 定数/マクロ（エイリアス解析に必要なもの） ---
+inline constexpr const char* GROUP_OBJ0 = u8R"(
+[Object.0]
+effect.name=グループ制御
+X=0.00
+Y=0.00
+Z=0.00
+Group=1
+X軸回転=0.00
+Y軸回転=0.00
+Z軸回転=0.00
+拡大率=100.000
+対象レイヤー数=1
+)";
+
+inline constexpr const char* FILTER_OBJECT_OBJ0 = u8R"(
+[Object.0]
+effect.name=フィルタオブジェクト
+)"; 
+
+inline constexpr const char* GROUP_AUDIO_OBJ0 = u8R"(
+[Object.0]
+effect.name=グループ制御(音声)
+音量=100.00
+左右=0.00
+対象レイヤー数=1
+)";
+
+// 出力切り替えセクション/特殊メディアオブジェクトの一覧は effect_registry.h を参照
+
+/// パース済みエイリアスデータ
+/// 文字列はコピーせず、解析元のエイリアスを参照する（解析元より長く保持しないこと）
+struct ObjSec {
+	std::string_view sec;			// [Object.x] セクションの文字列
+	std::string_view body;			// [Object.x] の直後からセクション末尾まで
+	int index;						// [Object.x] の x の部分
+	std::string_view effect_name;
+	EffectId effect_id;				// effect.name を登録表で引いた結果 (未登録なら UNKNOWN)
+};
+
+/// パース済みエイリアス
+struct ParsedAlias {
+	std::string_view header;		// [Object] ～ [Object.0] の直前まで
+	std::vector<ObjSec> objs;
+};
+
+/// セクションのパラメータ (key -> value) の索引
+/// key, value は解析元のエイリアスを参照する
+typedef std::unordered_map<std::string_view, std::string_view> SectionParams;
+
+/// 解析済みエイリアスと解析元の文字列
+/// parsed は alias を参照するため、作成後は shared_ptr で共有して書き換えないこと
+struct AliasModel {
+	std::shared_ptr<const std::string> alias;
+	ParsedAlias parsed;
+
+	/// parsed.objs[section] のパラメータの索引 (section が範囲外なら空の索引)
+	/// 索引は最初に参照したときにセクションごとに作成する (複数スレッドから同時に呼び出してよい)
+	const SectionParams& params(size_t section) const;
+	/// parsed.objs[section] の key の値を返す (なければ空)
+	std::string_view param(size_t section, std::string_view key) const;
+
+private:
+	struct SectionIndex {
+		std::once_flag once;
+		SectionParams params;
+	};
+	mutable std::once_flag index_once;
+	mutable std::unique_ptr<SectionIndex[]> index;	// parsed.objs と同じ添字
+};
+
+/// 1オブジェクト分の解析結果
+/// コマンド内で一度だけ作成し、各ビルダーで共有する
+struct SplitPlan {
+	std::shared_ptr<const AliasModel> model;	// 解析済みエイリアス (キャッシュと共有する)
+	int start_index = 0;		// 追加フィルタ効果の開始インデックス (calc_start_index)
+	bool is_filter_object = false;	// [Object.0] がフィルタオブジェクトか
+
+	/// 解析済みエイリアス (未作成なら空)
+	const ParsedAlias& parsed() const;
+	/// 追加フィルタ効果の数
+	int filter_count() const { return (int)parsed().objs.size() - start_index; }
+	/// 追加フィルタ効果があるか
+	bool has_filters() const { return filter_count() > 0; }
+};
+
+/// オブジェクトが映像と音声のどちらを扱うか
+enum class MediaKind {
+	UNKNOWN,
+	VIDEO,
+	AUDIO
+};
+
+/// エフェクト名の一致条件
+/// 完全一致の名前と、ワイルドカード (* は任意の文字列、? は任意の1文字) を含むパターンを並べたもの
+class EffectNameFilter {
+public:
+	EffectNameFilter() = default;
+	/// ';' 区切りのパターン一覧から作成する (前後の空白は無視する)
+	explicit EffectNameFilter(std::string_view patterns);
+
+	/// パターンがないか
+	bool empty() const { return names.empty() && globs.empty(); }
+	/// effect_name がいずれかのパターンに一致するか
+	bool matches(std::string_view effect_name) const;
+	/// 作成元のパターン一覧
+	std::string_view patterns() const { return source ? std::string_view(*source) : std::string_view(); }
+
+private:
+	std::shared_ptr<const std::string> source;		// names, globs が参照するパターン一覧
+	std::unordered_set<std::string_view> names;		// ワイルドカードを含まないパターン
+	std::vector<std::string_view> globs;			// ワイルドカードを含むパターン
+};
+
+/// エイリアスデータの組み立て
+/// 追加された部品から出力サイズを先に計算し、一度だけ確保して書き出す
+class AliasBuilder {
+public:
+	/// 文字列をそのまま追加する
+	AliasBuilder& append(std::string_view text);
+	/// objs[first_index]～objs[last_index - 1] を [Object.base_index] から振り直して追加する
+	AliasBuilder& append_sections(const std::vector<ObjSec>& objs, int first_index, int last_index, int base_index);
+	/// 組み立てたエイリアスデータを返す
+	std::string build() const;
+	/// 組み立てたエイリアスデータを、部品の解析結果から求めた AliasModel として返す (再解析しない)
+	std::shared_ptr<const AliasModel> build_model() const;
+
+private:
+	struct Part {
+		std::string_view text;
+		const std::vector<ObjSec>* objs;
+		int first_index;
+		int last_index;
+		int base_index;
+	};
+	void add_part(const Part& part);
+	const Part& part_at(int p) const { return more_parts.empty() ? parts[p] : more_parts[p]; }
+
+	// 部品が MAX_PARTS 個までは確保せずに保持し、それを超えたら more_parts に移す
+	static const int MAX_PARTS = 4;
+	Part parts[MAX_PARTS] = {};
+	std::vector<Part> more_parts;
+	int part_num = 0;
+};
+
+ParsedAlias parse_alias(std::string_view alias);
+int calc_start_index(const std::vector<ObjSec>& objs, bool include_self_filter = false);
+bool has_output_section(const std::vector<ObjSec>& objs);
+bool is_none_output_object(const std::vector<ObjSec>& objs);
+SplitPlan make_split_plan(std::shared_ptr<const std::string> alias, bool include_self_filter = false);
+std::shared_ptr<const std::string> build_source_alias(const SplitPlan& plan);
+std::shared_ptr<const std::string> build_target_alias(const SplitPlan& plan);
+std::shared_ptr<const std::string> build_single_filter_alias(const SplitPlan& plan, int filter_index);
+std::vector<int> find_matching_filters(const SplitPlan& plan, const EffectNameFilter& filter);
+std::shared_ptr<const std::string> build_selected_filters_alias(const SplitPlan& plan, const std::vector<int>& indices);
+std::shared_ptr<const std::string> build_unselected_alias(const SplitPlan& plan, const std::vector<int>& indices);
+std::shared_ptr<const std::string> build_remaining_alias(const SplitPlan& plan, int filter_count);
+std::shared_ptr<const std::string> build_leading_filters_alias(const SplitPlan& plan, int filter_count);
+std::shared_ptr<const std::string> build_merged_alias(const SplitPlan& dest, const SplitPlan& src, int filter_count);
+std::shared_ptr<const std::string> build_replaced_filters_alias(const SplitPlan& dest, const SplitPlan& src);
+std::shared_ptr<const std::string> build_group_alias(const SplitPlan& plan, bool audio);
+std::shared_ptr<const std::string> build_shared_group_alias(const SplitPlan& plan, int filter_count, int layer_count, bool audio);
+std::vector<uint64_t> hash_filter_sections(const SplitPlan& plan);
+int common_filter_suffix(const SplitPlan& a, const std::vector<uint64_t>& a_hashes, const SplitPlan& b, const std::vector<uint64_t>& b_hashes);
+std::shared_ptr<const std::string> build_collapsed_alias(const std::vector<const SplitPlan*>& plans);
+MediaKind lookup_media_kind(std::string_view effect_name);
+MediaKind classify_media_kind(const SplitPlan& plan);
+void learn_media_kind(const SplitPlan& plan, MediaKind kind);
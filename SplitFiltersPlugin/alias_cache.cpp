@@ -0,0 +1,165 @@
+#include "alias_cache.h"
+#include "profiler.h"
+#include <cstring>
+
+/// 8 バイトを読み出す
+static uint64_t load64(const char* p) {
+	uint64_t w;
+	std::memcpy(&w, p, 8);
+	return w;
+}
+
+
+/// エイリアスの内容のハッシュ
+/// すべての内容を混ぜる (一部だけでは、パラメータの値だけが異なるエイリアスが衝突して入れ替わり続ける)
+/// 32 バイトずつ 4 つの独立した系列で混ぜ、乗算の待ち時間を重ねる
+/// (一致はハッシュではなく内容の比較で確認するため、衝突してもキャッシュに当たらないだけ)
+static uint64_t hash_alias(std::string_view alias) {
+	const uint64_t m = 0xff51afd7ed558ccdull;
+	auto mix = [m](uint64_t h, uint64_t w) {
+		h = (h ^ w) * m;
+		return h ^ (h >> 32);
+	};
+
+	const char* p = alias.data();
+	const size_t n = alias.size();
+	uint64_t lanes[4] = {
+		0x9e3779b97f4a7c15ull ^ n, 0xc2b2ae3d27d4eb4full, 0x165667b19e3779f9ull, 0x27d4eb2f165667c5ull
+	};
+	size_t i = 0;
+	for (; i + 32 <= n; i += 32) {
+		for (int k = 0; k < 4; k++) lanes[k] = mix(lanes[k], load64(p + i + k * 8));
+	}
+	uint64_t h = lanes[0];
+	for (int k = 1; k < 4; k++) h = mix(h, lanes[k]);
+	for (; i + 8 <= n; i += 8) h = mix(h, load64(p + i));
+	if (i < n) {
+		uint64_t w = 0;
+		std::memcpy(&w, p + i, n - i);
+		h = mix(h, w);
+	}
+	return h;
+}
+
+
+AliasCache::AliasCache(size_t max_entries, size_t max_bytes)
+	: max_entries(max_entries), max_bytes(max_bytes) {
+}
+
+
+AliasCache::~AliasCache() {
+	for (StagedModel* node = staged.exchange(nullptr); node; ) {
+		StagedModel* next = node->next;
+		delete node;
+		node = next;
+	}
+}
+
+
+std::shared_ptr<const AliasModel> AliasCache::find(std::string_view alias) {
+	const uint64_t key = hash_alias(alias);
+
+	std::lock_guard<std::mutex> lock(mutex);
+	lookup_count++;
+	auto it = index.find(key);
+	if (it == index.end() || *it->second->model->alias != alias) {
+		profile_count(ProfileCounter::ALIAS_CACHE_MISS);
+		return nullptr;
+	}
+
+	hit_count++;
+	profile_count(ProfileCounter::ALIAS_CACHE_HIT);
+	entries.splice(entries.begin(), entries, it->second);
+	return it->second->model;
+}
+
+
+void AliasCache::insert(std::shared_ptr<const AliasModel> model) {
+	if (!model || !model->alias) return;
+	std::lock_guard<std::mutex> lock(mutex);
+	insert_locked(std::move(model));
+}
+
+
+/// 排他制御をした状態で追加する
+void AliasCache::insert_locked(std::shared_ptr<const AliasModel> model) {
+	const uint64_t key = hash_alias(*model->alias);
+	auto it = index.find(key);
+	if (it != index.end()) {
+		// 同じハッシュのものは新しい方で置き換える
+		bytes -= it->second->model->alias->size();
+		entries.erase(it->second);
+	}
+	entries.push_front({ key, std::move(model) });
+	index[key] = entries.begin();
+	bytes += entries.front().model->alias->size();
+	evict();
+}
+
+
+void AliasCache::stage(std::shared_ptr<const AliasModel> model) {
+	if (!model || !model->alias) return;
+	StagedModel* node = new StagedModel{ std::move(model), staged.load(std::memory_order_relaxed) };
+	while (!staged.compare_exchange_weak(node->next, node, std::memory_order_release, std::memory_order_relaxed)) {
+	}
+}
+
+
+void AliasCache::flush_staged() {
+	StagedModel* node = staged.exchange(nullptr, std::memory_order_acquire);
+	if (!node) return;
+
+	// 後から追加したものほど先頭にあるため、逆順にして追加した順に登録する
+	// 上限の数より前のものは追加してもすぐに捨てられるため、追加しない
+	StagedModel* ordered = nullptr;
+	size_t kept = 0;
+	while (node) {
+		StagedModel* next = node->next;
+		if (kept < max_entries) {
+			node->next = ordered;
+			ordered = node;
+			kept++;
+		}
+		else {
+			delete node;
+		}
+		node = next;
+	}
+
+	std::lock_guard<std::mutex> lock(mutex);
+	while (ordered) {
+		StagedModel* next = ordered->next;
+		insert_locked(std::move(ordered->model));
+		delete ordered;
+		ordered = next;
+	}
+}
+
+
+uint64_t AliasCache::hits() const {
+	std::lock_guard<std::mutex> lock(mutex);
+	return hit_count;
+}
+
+
+uint64_t AliasCache::lookups() const {
+	std::lock_guard<std::mutex> lock(mutex);
+	return lookup_count;
+}
+
+
+/// 上限を超えている間、最も長く使っていないものを捨てる (直前に追加したものは残す)
+void AliasCache::evict() {
+	while (entries.size() > 1 && (entries.size() > max_entries || bytes > max_bytes)) {
+		const Entry& last = entries.back();
+		bytes -= last.model->alias->size();
+		index.erase(last.key);
+		entries.pop_back();
+	}
+}
+
+
+AliasCache& alias_cache() {
+	static AliasCache cache(ALIAS_CACHE_MAX_ENTRIES, ALIAS_CACHE_MAX_BYTES);
+	return cache;
+}
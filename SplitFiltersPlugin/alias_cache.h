@@ -0,0 +1,66 @@
+#pragma once
+#include "alias.h"
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+
+/// 解析済みエイリアスのキャッシュの上限 (エントリ数)
+const size_t ALIAS_CACHE_MAX_ENTRIES = 64;
+
+/// 解析済みエイリアスのキャッシュの上限 (エイリアスの合計バイト数)
+const size_t ALIAS_CACHE_MAX_BYTES = 16 * 1024 * 1024;
+
+/// 解析済みエイリアスの LRU キャッシュ
+/// エイリアスの内容のハッシュで引き、同じ内容のエイリアスを再解析しない
+/// 複数スレッドから同時に呼び出してよい
+/// 並列処理中に解析・作成したものは stage で溜めておき、並列処理の後に flush_staged でまとめて追加する
+/// (並列処理中は追加のためにキャッシュ全体の排他制御を待たない)
+class AliasCache {
+public:
+	AliasCache(size_t max_entries, size_t max_bytes);
+	~AliasCache();
+	AliasCache(const AliasCache&) = delete;
+	AliasCache& operator=(const AliasCache&) = delete;
+
+	/// alias と同じ内容の解析済みエイリアスを返す (なければ nullptr)
+	std::shared_ptr<const AliasModel> find(std::string_view alias);
+	/// 解析済みエイリアスを追加する (上限を超えたら古いものから捨てる)
+	void insert(std::shared_ptr<const AliasModel> model);
+	/// 解析済みエイリアスを追加待ちにする (排他制御をせず、find の対象にはまだならない)
+	void stage(std::shared_ptr<const AliasModel> model);
+	/// 追加待ちのものを追加した順にキャッシュに追加する
+	void flush_staged();
+
+	/// これまでに find がキャッシュにあった回数
+	uint64_t hits() const;
+	/// これまでに find を呼び出した回数
+	uint64_t lookups() const;
+
+private:
+	struct Entry {
+		uint64_t key;
+		std::shared_ptr<const AliasModel> model;
+	};
+	/// 追加待ちの解析済みエイリアス (後から追加したものが先頭)
+	struct StagedModel {
+		std::shared_ptr<const AliasModel> model;
+		StagedModel* next;
+	};
+	void insert_locked(std::shared_ptr<const AliasModel> model);
+	void evict();
+
+	mutable std::mutex mutex;
+	std::list<Entry> entries;	// 先頭ほど最近使ったもの
+	std::unordered_map<uint64_t, std::list<Entry>::iterator> index;
+	size_t max_entries;
+	size_t max_bytes;
+	size_t bytes = 0;
+	uint64_t hit_count = 0;
+	uint64_t lookup_count = 0;
+	std::atomic<StagedModel*> staged{ nullptr };
+};
+
+/// プラグイン全体で共有するキャッシュ
+AliasCache& alias_cache();
@@ -0,0 +1,111 @@
+#include "alloc_stats.h"
+
+#if defined(SPLIT_FILTERS_ALLOC_STATS)
+#include <atomic>
+#include <cstdlib>
+#include <malloc.h>
+#include <new>
+
+static std::atomic<bool> g_counting(false);
+static std::atomic<uint64_t> g_count(0);
+static std::atomic<uint64_t> g_bytes(0);
+static std::atomic<int64_t> g_live(0);	// 計測開始時点からの使用量の増減
+static std::atomic<int64_t> g_peak(0);
+
+
+/// 確保したブロックの実際の大きさ
+static size_t block_size(void* p) {
+#if defined(_MSC_VER)
+	return _msize(p);
+#else
+	return malloc_usable_size(p);
+#endif
+}
+
+
+static void* counted_alloc(size_t size) {
+	void* p = std::malloc(size ? size : 1);
+	if (!p) throw std::bad_alloc();
+	if (g_counting.load(std::memory_order_relaxed)) {
+		size_t n = block_size(p);
+		g_count.fetch_add(1, std::memory_order_relaxed);
+		g_bytes.fetch_add(n, std::memory_order_relaxed);
+		int64_t live = g_live.fetch_add((int64_t)n, std::memory_order_relaxed) + (int64_t)n;
+		int64_t peak = g_peak.load(std::memory_order_relaxed);
+		while (live > peak && !g_peak.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {}
+	}
+	return p;
+}
+
+
+static void counted_free(void* p) {
+	if (!p) return;
+	if (g_counting.load(std::memory_order_relaxed)) {
+		g_live.fetch_sub((int64_t)block_size(p), std::memory_order_relaxed);
+	}
+	std::free(p);
+}
+
+
+void* operator new(size_t size) { return counted_alloc(size); }
+void* operator new[](size_t size) { return counted_alloc(size); }
+void operator delete(void* p) noexcept { counted_free(p); }
+void operator delete[](void* p) noexcept { counted_free(p); }
+void operator delete(void* p, size_t) noexcept { counted_free(p); }
+void operator delete[](void* p, size_t) noexcept { counted_free(p); }
+
+
+bool alloc_stats_available() {
+	return true;
+}
+
+
+void alloc_stats_begin() {
+	g_count = 0;
+	g_bytes = 0;
+	g_live = 0;
+	g_peak = 0;
+	g_counting = true;
+}
+
+
+AllocStats alloc_stats_end() {
+	g_counting = false;
+	return { g_count.load(), g_bytes.load(), (uint64_t)g_peak.load() };
+}
+
+
+bool alloc_stats_suspend() {
+	return g_counting.exchange(false);
+}
+
+
+void alloc_stats_resume(bool counting) {
+	g_counting = counting;
+}
+
+#else
+
+bool alloc_stats_available() {
+	return false;
+}
+
+
+void alloc_stats_begin() {
+}
+
+
+AllocStats alloc_stats_end() {
+	return {};
+}
+
+
+bool alloc_stats_suspend() {
+	return false;
+}
+
+
+void alloc_stats_resume(bool) {
+}
+
+#endif
@@ -0,0 +1,25 @@
+#pragma once
+#include <cstdint>
+
+// --- ヒープ確保の計測 (デバッグ用) ---
+// SPLIT_FILTERS_ALLOC_STATS を定義してビルドしたときだけ operator new / delete を置き換えて数える
+// 定義しない場合は何も数えず、alloc_stats_available() が false を返す
+
+/// コマンド1回分のヒープ確保の集計
+struct AllocStats {
+	uint64_t count;			// 確保した回数
+	uint64_t bytes;			// 確保したバイト数の合計
+	uint64_t peak_bytes;	// 開始時点から増えた使用量の最大値
+};
+
+/// ヒープ確保の計測が組み込まれているか
+bool alloc_stats_available();
+/// 計測を開始する
+void alloc_stats_begin();
+/// 計測を終了して集計を返す
+AllocStats alloc_stats_end();
+/// 計測を一時的に止める (テストでホストを模擬する処理の確保を数えないため)
+/// @return 止める前に計測していたか (alloc_stats_resume に渡す)
+bool alloc_stats_suspend();
+/// alloc_stats_suspend で止めた計測を元に戻す
+void alloc_stats_resume(bool counting);
@@ -0,0 +1,38 @@
+#include "arena.h"
+
+/// 実行中のコマンドの作業領域
+/// コマンドはホストのスレッドから1つずつ呼び出されるため、入れ子にはならない
+static std::pmr::memory_resource* g_command_resource = nullptr;
+
+
+CommandArena::CommandArena()
+	: buffer(COMMAND_ARENA_INITIAL_BYTES), previous(g_command_resource) {
+	g_command_resource = this;
+}
+
+
+CommandArena::~CommandArena() {
+	g_command_resource = previous;
+}
+
+
+void* CommandArena::do_allocate(size_t bytes, size_t alignment) {
+	std::lock_guard<std::mutex> lock(mutex);
+	allocated += bytes;
+	return buffer.allocate(bytes, alignment);
+}
+
+
+void CommandArena::do_deallocate(void*, size_t, size_t) {
+	// 作業領域の破棄時にまとめて解放する
+}
+
+
+bool CommandArena::do_is_equal(const std::pmr::memory_resource& other) const noexcept {
+	return this == &other;
+}
+
+
+std::pmr::memory_resource* command_resource() {
+	return g_command_resource ? g_command_resource : std::pmr::new_delete_resource();
+}
@@ -0,0 +1,39 @@
+#pragma once
+#include <memory_resource>
+#include <mutex>
+
+// --- コマンド1回分の作業領域 ---
+// レイヤーの使用区間や変更の計画など、コマンドの中だけで使うデータをまとめて確保し、
+// コマンドの終わりに一度に解放する (個別の解放は行わない)
+// 解析済みエイリアスや作成したエイリアスはキャッシュに残るため、ここからは確保しない
+
+/// 作業領域の最初のブロックの大きさ (これを超えると上流のヒープから倍々に確保する)
+const size_t COMMAND_ARENA_INITIAL_BYTES = 64 * 1024;
+
+/// コマンド1回分の作業領域
+/// 並列処理中にも確保されるため、確保・解放は排他制御する
+class CommandArena : public std::pmr::memory_resource {
+public:
+	/// 作業領域を作成し、command_resource() が返すようにする
+	CommandArena();
+	/// 作業領域をまとめて解放し、command_resource() を元に戻す
+	~CommandArena();
+	CommandArena(const CommandArena&) = delete;
+	CommandArena& operator=(const CommandArena&) = delete;
+
+	/// これまでに確保したバイト数
+	size_t allocated_bytes() const { return allocated; }
+
+private:
+	void* do_allocate(size_t bytes, size_t alignment) override;
+	void do_deallocate(void* p, size_t bytes, size_t alignment) override;
+	bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+
+	std::mutex mutex;
+	std::pmr::monotonic_buffer_resource buffer;
+	std::pmr::memory_resource* previous;
+	size_t allocated = 0;
+};
+
+/// 実行中のコマンドの作業領域 (コマンド外ではヒープ)
+std::pmr::memory_resource* command_resource();
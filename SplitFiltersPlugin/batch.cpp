@@ -0,0 +1,37 @@
+#include "batch.h"
+#include <algorithm>
+#include <climits>
+
+Batch::Batch(std::string command, TargetScope scope, std::vector<TargetObject> targets)
+	: name(std::move(command)), target_scope(scope), targets(std::move(targets)) {
+	std::sort(this->targets.begin(), this->targets.end(), [](const TargetObject& a, const TargetObject& b) {
+		if (a.lf.start != b.lf.start) return a.lf.start < b.lf.start;
+		return a.lf.layer < b.lf.layer;
+	});
+}
+
+
+std::vector<TargetObject> Batch::take_chunk() {
+	const size_t first = next;
+	int end_frame = INT_MIN;	// 区切りに入れたオブジェクトの最後のフレーム
+	while (next < targets.size()) {
+		const auto& lf = targets[next].lf;
+		if (next - first >= chunk && lf.start > end_frame) break;
+		end_frame = std::max(end_frame, lf.end);
+		next++;
+	}
+	last_chunk = next - first;
+	return std::vector<TargetObject>(targets.begin() + first, targets.begin() + next);
+}
+
+
+void Batch::record_chunk(double elapsed_ms) {
+	if (last_chunk == 0) return;
+	const double ms = elapsed_ms / last_chunk;
+	object_ms = object_ms > 0.0 ? (object_ms + ms) / 2 : ms;
+	if (object_ms > 0.0) {
+		// 見積もりが外れたときに区切りが長くなりすぎないよう、一度に増やすのは2倍まで
+		const double target = std::min(BATCH_CHUNK_BUDGET_MS / object_ms, (double)last_chunk * 2);
+		chunk = (size_t)std::clamp(target, (double)BATCH_MIN_CHUNK, (double)BATCH_MAX_CHUNK);
+	}
+}
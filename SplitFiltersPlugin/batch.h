@@ -0,0 +1,61 @@
+#pragma once
+#include "timeline.h"
+#include <string>
+#include <vector>
+
+// --- 対象が多いコマンドの分割実行 ---
+// 対象オブジェクトをフレーム範囲が重ならない区切りに分け、区切りごとに別の編集処理として同じコマンドを実行する
+// 区切りの間はホストに制御を戻すため、画面が更新され、中止の操作もできる
+// 各オブジェクトの変更は区切りの中で完結するため、中止しても処理済みのオブジェクトと未処理のオブジェクトしか残らない
+
+/// 分割実行を行う対象オブジェクト数の下限 (これ以下は一度に処理する)
+const size_t BATCH_MIN_OBJECTS = 256;
+/// 最初の区切りの対象オブジェクト数
+const size_t BATCH_INITIAL_CHUNK = 64;
+/// 区切りの対象オブジェクト数の下限・上限
+const size_t BATCH_MIN_CHUNK = 16;
+const size_t BATCH_MAX_CHUNK = 4096;
+/// 区切り1回の処理時間の目安 (ミリ秒)
+const double BATCH_CHUNK_BUDGET_MS = 50.0;
+
+/// 分割実行の対象と進み具合
+class Batch {
+public:
+	/// @param command 区切りごとに実行するコマンド名
+	/// @param scope 開始時の対象範囲 (区切りもこの対象範囲として実行する)
+	/// @param targets 対象オブジェクト (alias は不要)
+	Batch(std::string command, TargetScope scope, std::vector<TargetObject> targets);
+
+	/// 次の区切りの対象オブジェクトを取り出す
+	/// 区切りをまたいでフレーム範囲が重ならないよう、重なるオブジェクトは同じ区切りに入れる
+	/// (上下に重なるオブジェクトの配置・結合が区切りの中で完結する)
+	std::vector<TargetObject> take_chunk();
+	/// 直前の区切りの処理時間を記録し、1オブジェクトあたりの処理時間から次の区切りの大きさを決める
+	void record_chunk(double elapsed_ms);
+
+	const std::string& command() const { return name; }
+	TargetScope scope() const { return target_scope; }
+
+	/// 一括追加・置換で、すべての区切りに使うフォーカス中のオブジェクトを設定する (開始時に取得・解析したもの)
+	void set_donor(TargetObject object, SplitPlan plan) {
+		donor_object = std::move(object);
+		donor_split_plan = std::move(plan);
+	}
+	const TargetObject& donor() const { return donor_object; }
+	const SplitPlan& donor_plan() const { return donor_split_plan; }
+	/// 取り出した対象オブジェクトの数
+	size_t done() const { return next; }
+	size_t total() const { return targets.size(); }
+	bool finished() const { return next >= targets.size(); }
+
+private:
+	std::string name;
+	TargetScope target_scope;
+	std::vector<TargetObject> targets;	// 開始フレーム順
+	size_t next = 0;
+	size_t last_chunk = 0;				// 直前の区切りの対象オブジェクト数
+	size_t chunk = BATCH_INITIAL_CHUNK;
+	double object_ms = 0.0;				// 1オブジェクトあたりの処理時間 (移動平均)
+	TargetObject donor_object = {};		// 一括追加・置換のフォーカス中のオブジェクト
+	SplitPlan donor_split_plan;
+};
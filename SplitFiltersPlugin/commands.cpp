@@ -0,0 +1,1195 @@
+#include "commands.h"
+
+// --- 外部変数の実体定義 ---
+EDIT_HANDLE* edit_handle;
+LOG_HANDLE* logger;
+CONFIG_HANDLE* config;
+
+/// 編集メニューから実行するコマンドの対象範囲 (編集メニュー「対象範囲」で切り替える)
+static TargetScope g_target_scope = TargetScope::SELECTION;
+/// オブジェクトメニューから実行中か (対象範囲によらず選択中オブジェクトを対象にする)
+static bool g_from_object_menu = false;
+
+/// 「フィルタ分離（指定フィルタのみ）」で分離するフィルタ効果のエフェクト名の条件
+EffectNameFilter g_split_match;
+
+/// 実行中のコマンド (分割実行なら全体) で集計したスキップ・失敗
+static Diagnostics g_diagnostics;
+/// 失敗したエイリアスなど、詳細な診断を verbose ログに出力するか
+bool g_verbose_diagnostics = false;
+
+/// 実行中の分割実行 (なければ nullptr)
+static std::unique_ptr<Batch> g_batch;
+/// 分割実行の区切りを実行中か
+static bool g_batch_running = false;
+/// 記録したコマンドを再生中か (記録時と同じ呼び出しになるよう、分割しない)
+static bool g_replaying = false;
+
+/// 最後に終了したコマンドの集計
+static CommandStats g_last_command_stats;
+
+static bool run_command(const char* command, EDIT_SECTION* edit);
+static void finish_batch_chunk(double elapsed_ms);
+
+
+/// 実行中のコマンドの対象範囲
+/// 分割実行の区切りは開始時の対象範囲、オブジェクトメニューからは選択中オブジェクト、編集メニューからは g_target_scope
+static TargetScope command_scope() {
+	if (g_batch_running) return g_batch->scope();
+	if (g_from_object_menu) return TargetScope::SELECTION;
+	return g_target_scope;
+}
+
+
+/// コマンドごとのホスト呼び出しとヒープ確保の予算
+/// 対象オブジェクトと作成したオブジェクト1つあたりの回数に、ホスト呼び出しは走査しうるレイヤー数を加えたものを予算とする
+/// (レイヤーの走査や作業領域の外での確保などが対象数に比例しなくなったことを検出するため、実測値の2倍程度にしてある)
+static const struct {
+	const char* command;
+	uint32_t calls_per_object;
+	uint32_t allocs_per_object;
+} COMMAND_BUDGETS[] = {
+	{ "split_filters", 5, 12 },
+	{ "split_matching_filters", 5, 13 },
+	{ "split_filters_for_group", 5, 12 },
+	{ "split_filters_for_shared_group", 5, 14 },
+	{ "explode_filters", 4, 12 },
+	{ "merge_filters", 10, 21 },
+	{ "merge_head_filters", 8, 18 },
+	{ "broadcast_append_filters", 4, 12 },
+	{ "broadcast_replace_filters", 4, 12 },
+	{ "collapse_filters", 14, 24 },
+};
+
+/// ホスト呼び出しの予算のうち、対象オブジェクトの数によらない回数
+const uint32_t HOST_CALL_BUDGET_BASE = 16;
+/// ヒープ確保の予算のうち、対象オブジェクトの数によらない回数
+const uint32_t ALLOC_BUDGET_BASE = 256;
+
+
+/// コマンド1回分の作業領域と処理時間の計測 (スコープを抜けるときに集計を verbose ログに出力する)
+/// 作業領域はコマンド内の他のオブジェクトより先に作成し、最後に解放するため、コマンドの先頭で作成すること
+/// 記録が有効な場合は、edit を呼び出しを記録する EDIT_SECTION に差し替える
+struct CommandProfile {
+	CommandProfile(const char* command, EDIT_SECTION*& edit) : command(command) {
+		profile_begin_command(command);
+		if (profile_enabled()) alloc_stats_begin();
+		g_host_calls = {};
+		if (edit->info) layers = edit->info->layer_max + 1;
+		edit = trace_begin_command(edit, command, (int)command_scope(), g_split_match.patterns());
+	}
+	~CommandProfile() {
+		// 並列処理中に解析・作成したエイリアスを、次のコマンドのためにキャッシュに追加する
+		alias_cache().flush_staged();
+		trace_end_command();
+		const AllocStats allocs = alloc_stats_end();
+		const HostCallCounts calls = g_host_calls;
+		const uint64_t budget = host_call_budget(calls);
+		const uint64_t alloc_budget = heap_alloc_budget(calls);
+		g_last_command_stats = { command, targets, calls, budget, allocs, alloc_budget };
+
+		// ホスト呼び出しが予算を超えていれば、計測の有効・無効にかかわらず警告する
+		wchar_t buf[160];
+		if (calls.total() > budget) {
+			std::swprintf(buf, 160, L"[budget] %hs: %u host calls for %zu objects (budget %llu)", command, calls.total(), targets, (unsigned long long)budget);
+			logger->verbose(logger, buf);
+		}
+		if (alloc_stats_available() && allocs.count > alloc_budget) {
+			std::swprintf(buf, 160, L"[budget] %hs: %llu heap allocs for %zu objects (budget %llu)", command, (unsigned long long)allocs.count, targets, (unsigned long long)alloc_budget);
+			logger->verbose(logger, buf);
+		}
+
+		// 分割実行の区切りであれば、次の区切りを予約する
+		if (chunk) {
+			finish_batch_chunk(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - chunk_start).count());
+		}
+		// 集計したスキップ・失敗は、分割実行なら全体が終わってから出力する
+		if (!g_batch) g_diagnostics.flush(logger);
+
+		std::wstring report = profile_end_command();
+		if (report.empty()) return;
+
+		// ホスト呼び出しの回数と予算
+		std::swprintf(buf, 160, L"\n  host calls: %u (budget %llu)", calls.total(), (unsigned long long)budget);
+		report += buf;
+
+		// ヒープ確保の回数と使用量 (SPLIT_FILTERS_ALLOC_STATS を定義したビルドのみ) と、作業領域から確保した量
+		if (alloc_stats_available()) {
+			std::swprintf(buf, 160, L"\n  heap: %llu allocs (budget %llu), %llu bytes, peak %llu bytes", (unsigned long long)allocs.count, (unsigned long long)alloc_budget, (unsigned long long)allocs.bytes, (unsigned long long)allocs.peak_bytes);
+			report += buf;
+		}
+		std::swprintf(buf, 160, L"\n  arena: %zu bytes", arena.allocated_bytes());
+		report += buf;
+
+		// 解析済みエイリアスのキャッシュの、プラグイン読み込みからの通算の命中率
+		const auto& cache = alias_cache();
+		if (uint64_t lookups = cache.lookups()) {
+			std::swprintf(buf, 160, L"\n  alias cache: %llu / %llu hits (%.1f%%)", (unsigned long long)cache.hits(), (unsigned long long)lookups, 100.0 * cache.hits() / lookups);
+			report += buf;
+		}
+		logger->verbose(logger, report.c_str());
+	}
+
+	/// ホスト呼び出しの予算 (予算のないコマンドは上限なし)
+	uint64_t host_call_budget(const HostCallCounts& calls) const {
+		for (const auto& entry : COMMAND_BUDGETS) {
+			if (std::strcmp(entry.command, command) != 0) continue;
+			return HOST_CALL_BUDGET_BASE + layers + (uint64_t)entry.calls_per_object * (std::max(targets, located) + calls.create_object);
+		}
+		return UINT64_MAX;
+	}
+
+	/// ヒープ確保の予算 (予算のないコマンドは上限なし)
+	uint64_t heap_alloc_budget(const HostCallCounts& calls) const {
+		for (const auto& entry : COMMAND_BUDGETS) {
+			if (std::strcmp(entry.command, command) != 0) continue;
+			return ALLOC_BUDGET_BASE + (uint64_t)entry.allocs_per_object * (std::max(targets, located) + calls.create_object);
+		}
+		return UINT64_MAX;
+	}
+
+	const char* command;
+	size_t targets = 0;		// 対象オブジェクトの数 (対象を取得したら設定する)
+	size_t located = 0;		// 分割実行の最初の区切りで、位置を調べたすべての対象の数
+	bool chunk = false;		// 分割実行の区切りか
+	std::chrono::steady_clock::time_point chunk_start;	// 区切りの処理を始めた時刻 (最初の区切りは対象の取得後から)
+	int layers = 0;			// 走査しうるレイヤー数
+	CommandArena arena;
+};
+
+
+const CommandStats& last_command_stats() {
+	return g_last_command_stats;
+}
+
+
+/// 対象オブジェクトがないことを通知する
+static void report_no_targets() {
+	logger->info(logger, message(command_scope() == TargetScope::SELECTION ? Msg::NO_SELECTION : Msg::NO_TARGET_IN_SCOPE));
+	notify_beep();
+}
+
+
+/// 対象オブジェクトを処理できなかったことを集計する (コマンドの終了時にまとめて通知する)
+/// 選択中オブジェクト以外の範囲では対象外のオブジェクトが多く含まれるため、音は鳴らさず verbose ログにのみ出力する
+/// @param lf 対象オブジェクトの位置
+/// @param detail メッセージの後に括弧書きで添える内容 (UTF-8、翻訳しない)
+static void report_skipped(Msg id, const OBJECT_LAYER_FRAME& lf, std::string_view detail = {}) {
+	g_diagnostics.add(id, command_scope() == TargetScope::SELECTION ? DiagLevel::INFO : DiagLevel::VERBOSE, lf, detail);
+}
+
+
+/// 対象オブジェクトの変更に失敗したことを集計する (コマンドの終了時にまとめて警告する)
+/// @param lf 対象オブジェクトの位置
+static void report_failed(Msg id, const OBJECT_LAYER_FRAME& lf) {
+	g_diagnostics.add(id, DiagLevel::WARN, lf);
+}
+
+
+/// コマンドの対象オブジェクトを取得する
+/// 対象が多い場合は分割実行を始めて最初の区切りの対象だけを返し、残りはタイマーから区切りごとに同じコマンドで処理する
+/// 分割実行の区切りでは、その区切りの対象が同じ位置にあるか確かめ直して返す
+/// @param exclude 対象から除くオブジェクト (分割実行の区切りでも除く)
+/// @param targets [out] 対象オブジェクト (処理する順)
+/// @return 処理を続けるか (対象がなければ通知して false)
+static bool take_targets(EDIT_SECTION* edit, LayerOccupancy& occupancy, CommandProfile& profile, std::vector<TargetObject>& targets, OBJECT_HANDLE exclude = nullptr) {
+	auto remove_excluded = [&] {
+		if (!exclude) return;
+		targets.erase(std::remove_if(targets.begin(), targets.end(), [&](const TargetObject& t) { return t.obj == exclude; }), targets.end());
+	};
+
+	if (g_batch_running) {
+		profile.chunk_start = std::chrono::steady_clock::now();
+		targets = g_batch->take_chunk();
+		remove_excluded();
+		relocate_targets(edit, occupancy, targets);
+		profile.chunk = true;
+	}
+	else {
+		if (g_batch) {
+			logger->info(logger, message(Msg::BATCH_BUSY));
+			notify_beep();
+			return false;
+		}
+		targets = locate_targets(edit, occupancy, command_scope());
+		remove_excluded();
+
+		// 記録中・再生中は再生で同じ呼び出しになるよう、分割しない
+		if (targets.size() > BATCH_MIN_OBJECTS && edit_handle && !trace_enabled() && !g_replaying) {
+			wchar_t buf[160];
+			std::swprintf(buf, 160, message(Msg::BATCH_START), targets.size());
+			logger->info(logger, buf);
+			profile.chunk_start = std::chrono::steady_clock::now();
+			profile.located = targets.size();
+			g_batch = std::make_unique<Batch>(profile.command, command_scope(), std::move(targets));
+			targets = g_batch->take_chunk();
+			profile.chunk = true;
+		}
+	}
+
+	fetch_target_aliases(edit, targets);
+	profile.targets = targets.size();
+	if (targets.empty()) {
+		// 区切りの対象がすべて移動・削除されていた場合は、何もせずに次の区切りへ進む
+		if (!profile.chunk) report_no_targets();
+		return false;
+	}
+	return true;
+}
+
+
+/// 選択中オブジェクトのフィルタ効果部をフィルタオブジェクトに分離する
+/// @param filter 分離するフィルタ効果のエフェクト名の条件 (nullptr ならすべて分離する)
+static void split_filters(EDIT_SECTION* edit, const EffectNameFilter* filter) {
+	CommandProfile profile(filter ? "split_matching_filters" : "split_filters", edit);
+
+	// === 対象オブジェクトの取得 ===
+	LayerOccupancy occupancy(edit);
+	std::vector<TargetObject> targets;
+	if (!take_targets(edit, occupancy, profile, targets)) return;
+
+	// === 解析・エイリアス作成 (並列) ===
+	struct SplitOutput {
+		SplitPlan plan;
+		std::shared_ptr<const std::string> target_alias;	// フィルタ効果オブジェクト
+		std::shared_ptr<const std::string> source_alias;	// 元オブジェクト - 分離フィルタ
+		bool matched = false;		// 分離するフィルタ効果があるか
+		EditTransaction tx;
+	};
+	std::vector<SplitOutput> outputs(targets.size());
+	parallel_for(targets.size(), [&](size_t k) {
+		auto& out = outputs[k];
+		out.plan = make_split_plan(targets[k].alias);
+		if (!out.plan.has_filters()) return;
+		if (!filter) {
+			out.target_alias = build_target_alias(out.plan);
+			out.source_alias = build_source_alias(out.plan);
+			out.matched = true;
+			return;
+		}
+
+		// 一致したフィルタ効果だけを分離する (一度の解析から両方のエイリアスを作成する)
+		const auto indices = find_matching_filters(out.plan, *filter);
+		if (indices.empty()) return;
+		out.target_alias = build_selected_filters_alias(out.plan, indices);
+		out.source_alias = build_unselected_alias(out.plan, indices);
+		out.matched = true;
+	});
+
+	// === 変更内容の計画 ===
+	for (size_t k = 0; k < targets.size(); k++) {
+		const auto& lf = targets[k].lf;
+		auto& out = outputs[k];
+		if (!out.matched) continue;
+
+		// 重複しない最初のレイヤーを探して、複製先フィルタの位置を予約する
+		int free_layer = occupancy.find_available_layer(lf.layer + 1, lf.start, lf.end);
+		if (free_layer == -1) continue;
+		OBJECT_LAYER_FRAME target_lf = { free_layer, lf.start, lf.end };
+		occupancy.add(target_lf, nullptr);
+
+		// 複製先フィルタを作成してから、元オブジェクトを置き換える
+		out.tx.create(std::move(out.target_alias), target_lf);
+		out.tx.replace(targets[k], std::move(out.source_alias));
+	}
+
+	// === タイムラインへの反映 ===
+	for (size_t k = 0; k < targets.size(); k++) {
+		auto& out = outputs[k];
+
+		// 追加フィルタ効果がない場合
+		if (!out.plan.has_filters()) {
+			report_skipped(Msg::NO_FILTERS, targets[k].lf);
+			continue;
+		}
+		if (!out.matched) {
+			report_skipped(Msg::NO_MATCH, targets[k].lf);
+			continue;
+		}
+
+		if (out.tx.empty() || !out.tx.apply(edit, occupancy)) {
+			report_failed(out.tx.failed_op() == 1 ? Msg::SOURCE_CREATE_FAILED : Msg::FILTER_CREATE_FAILED, targets[k].lf);
+			continue;
+		}
+
+		auto new_obj = out.tx.result(0);
+		host_set_object_name(edit, new_obj, nullptr);
+		host_set_focus_object(edit, new_obj);
+	}
+}
+
+
+/// オブジェクトメニュー「フィルタ分離」
+/// 選択中オブジェクトのフィルタ効果部をフィルタオブジェクトに分離する
+void __cdecl split_filters_callback(EDIT_SECTION* edit) {
+	split_filters(edit, nullptr);
+}
+
+
+/// オブジェクトメニュー「フィルタ分離（指定フィルタのみ）」
+/// 選択中オブジェクトのフィルタ効果のうち、エフェクト名が条件に一致するものだけを分離する
+void __cdecl split_matching_filters_callback(EDIT_SECTION* edit) {
+	if (g_split_match.empty()) {
+		logger->info(logger, message(Msg::NO_MATCH_CONDITION));
+		notify_beep();
+		return;
+	}
+	split_filters(edit, &g_split_match);
+}
+
+
+/// 選択中オブジェクトのフィルタ効果部をグループ制御オブジェクトに分離する
+/// @param shared 同じフレーム範囲で隣り合うレイヤーのオブジェクトが末尾のフィルタ効果を共有していれば、1つのグループ制御にまとめるか
+static void split_filters_for_group(EDIT_SECTION* edit, bool shared) {
+	CommandProfile profile(shared ? "split_filters_for_shared_group" : "split_filters_for_group", edit);
+
+	// === 対象オブジェクトの取得 ===
+	LayerOccupancy occupancy(edit);
+	std::vector<TargetObject> targets;
+	if (!take_targets(edit, occupancy, profile, targets)) return;
+
+	// === 解析・エイリアス作成 (並列) ===
+	struct SplitOutput {
+		SplitPlan plan;
+		std::shared_ptr<const std::string> source_alias;	// 元オブジェクト - 分離フィルタ
+		MediaKind kind;				// 映像/音声の判定
+		std::shared_ptr<const std::string> group_alias;	// グループ制御 (音声と判定した場合はグループ制御(音声))
+		std::shared_ptr<const std::string> group_fallback_alias;	// 判定できなかった場合のグループ制御(音声)
+		std::vector<uint64_t> filter_hashes;	// 追加フィルタ効果のハッシュ値 (共有する場合のみ)
+		std::vector<size_t> members;	// グループ制御を共有する対象 (先頭の対象のみ、上のレイヤーから順に自身を含む)
+		int shared_filters = 0;			// 共有するフィルタ効果の数
+		bool grouped = false;			// 他の対象のグループ制御にまとめたか
+		int group_op = 1;				// グループ制御に置き換える操作のインデックス
+		EditTransaction tx;
+	};
+	std::vector<SplitOutput> outputs(targets.size());
+
+	// グループ制御のエイリアス (共有する場合は対象レイヤー数を共有する数にする)
+	auto make_group_alias = [&](const SplitOutput& out, bool audio) {
+		if (out.members.empty()) return build_group_alias(out.plan, audio);
+		return build_shared_group_alias(out.plan, out.shared_filters, (int)out.members.size(), audio);
+	};
+	auto build_aliases = [&](SplitOutput& out) {
+		if (out.members.empty()) {
+			out.source_alias = build_source_alias(out.plan);
+		}
+		else {
+			for (size_t m : out.members) {
+				outputs[m].source_alias = build_leading_filters_alias(outputs[m].plan, out.shared_filters);
+			}
+		}
+		out.group_alias = make_group_alias(out, out.kind == MediaKind::AUDIO);
+		if (out.kind == MediaKind::UNKNOWN) {
+			out.group_fallback_alias = make_group_alias(out, true);
+		}
+	};
+
+	parallel_for(targets.size(), [&](size_t k) {
+		auto& out = outputs[k];
+		out.plan = make_split_plan(targets[k].alias);
+		if (!out.plan.has_filters()) return;
+		out.kind = classify_media_kind(out.plan);
+		if (shared) {
+			out.filter_hashes = hash_filter_sections(out.plan);
+		}
+		else {
+			build_aliases(out);
+		}
+	});
+
+	if (shared) {
+		// === グループ制御を共有する対象をまとめる ===
+		// 同じフレーム範囲で連続するレイヤーに並び、末尾のフィルタ効果が共通するものを上から順にまとめる
+		// (グループ制御のフィルタ効果は各オブジェクトのフィルタ効果の後に掛かるため、末尾を共有すれば順序が変わらない)
+		std::vector<size_t> order;
+		for (size_t k = 0; k < targets.size(); k++) {
+			if (outputs[k].plan.has_filters()) order.push_back(k);
+		}
+		std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+			const auto& la = targets[a].lf;
+			const auto& lb = targets[b].lf;
+			if (la.start != lb.start) return la.start < lb.start;
+			if (la.end != lb.end) return la.end < lb.end;
+			return la.layer < lb.layer;
+		});
+
+		size_t i = 0;
+		while (i < order.size()) {
+			const size_t head = order[i];
+			std::vector<size_t> run = { head };
+			int suffix = outputs[head].plan.filter_count();
+			size_t j = i + 1;
+			for (; j < order.size(); j++) {
+				const auto& prev = targets[run.back()].lf;
+				const auto& lf = targets[order[j]].lf;
+				if (lf.start != prev.start || lf.end != prev.end || lf.layer != prev.layer + 1) break;
+				if (outputs[order[j]].kind != outputs[head].kind) break;
+
+				const auto& last = outputs[run.back()];
+				const auto& next = outputs[order[j]];
+				int common = std::min(suffix, common_filter_suffix(last.plan, last.filter_hashes, next.plan, next.filter_hashes));
+				// 共有するフィルタ効果の延べ数 (共有数 × (レイヤー数 - 1)) が減る場合は広げない
+				if (common == 0 || (run.size() > 1 && common * (int)run.size() < suffix * (int)(run.size() - 1))) break;
+				suffix = common;
+				run.push_back(order[j]);
+			}
+			i = j;
+			if (run.size() < 2) continue;
+
+			// グループ制御の下に並べ直すため、一番下のオブジェクトの1つ下が空いている必要がある
+			const auto& top = targets[head].lf;
+			OBJECT_LAYER_FRAME bottom_lf = { top.layer + (int)run.size(), top.start, top.end };
+			if (!occupancy.is_free(bottom_lf.layer, bottom_lf.start, bottom_lf.end)) continue;
+			occupancy.add(bottom_lf, nullptr);
+
+			outputs[head].shared_filters = suffix;
+			for (size_t m = 1; m < run.size(); m++) outputs[run[m]].grouped = true;
+			outputs[head].members = std::move(run);
+		}
+
+		parallel_for(targets.size(), [&](size_t k) {
+			auto& out = outputs[k];
+			if (out.plan.has_filters() && !out.grouped) build_aliases(out);
+		});
+	}
+
+	// === 変更内容の計画 ===
+	for (size_t k = 0; k < targets.size(); k++) {
+		const auto& lf = targets[k].lf;
+		auto& out = outputs[k];
+		if (!out.plan.has_filters() || out.grouped) continue;
+
+		if (!out.members.empty()) {
+			// 下のオブジェクトから順に1レイヤーずつ下げ、先頭の対象をグループ制御に置き換える
+			const int n = (int)out.members.size();
+			out.tx.reserve(2 * n);
+			for (int m = n - 1; m >= 0; m--) {
+				const auto& member = targets[out.members[m]];
+				out.tx.create(outputs[out.members[m]].source_alias, { member.lf.layer + 1, member.lf.start, member.lf.end });
+				if (m > 0) out.tx.remove(member);
+			}
+			out.group_op = out.tx.replace(targets[k], std::move(out.group_alias));
+			out.tx.set_fallback(std::move(out.group_fallback_alias));
+			continue;
+		}
+
+		// 重複しないレイヤーを探して、元オブジェクトの移動先を予約する (1レイヤー下に置く)
+		int free_layer = occupancy.find_available_layer(lf.layer + 1, lf.start, lf.end);
+		if (free_layer == -1) continue;
+		OBJECT_LAYER_FRAME source_lf = { free_layer, lf.start, lf.end };
+		occupancy.add(source_lf, nullptr);
+
+		// 元オブジェクトを作成してから、選択レイヤーをグループ制御に置き換える
+		// 映像/音声が判定できなかった場合は、グループ制御が作成できなければグループ制御(音声) を作る
+		out.tx.create(std::move(out.source_alias), source_lf);
+		out.group_op = out.tx.replace(targets[k], std::move(out.group_alias));
+		out.tx.set_fallback(std::move(out.group_fallback_alias));
+	}
+
+	// === タイムラインへの反映 ===
+	for (size_t k = 0; k < targets.size(); k++) {
+		auto& out = outputs[k];
+		if (out.grouped) continue;
+
+		// 追加フィルタ効果がない場合
+		if (!out.plan.has_filters()) {
+			report_skipped(Msg::NO_FILTERS, targets[k].lf);
+			continue;
+		}
+
+		// 同じコマンド内で先に判明した種類があれば、そのグループ制御だけを作成する
+		if (out.kind == MediaKind::UNKNOWN && !out.tx.empty()) {
+			out.kind = classify_media_kind(out.plan);
+			if (out.kind != MediaKind::UNKNOWN) {
+				out.tx.set_alias(out.group_op, make_group_alias(out, out.kind == MediaKind::AUDIO));
+			}
+		}
+
+		if (out.tx.empty() || !out.tx.apply(edit, occupancy)) {
+			report_failed(out.tx.failed_op() == out.group_op ? Msg::GROUP_CREATE_FAILED : Msg::SOURCE_CREATE_FAILED, targets[k].lf);
+			continue;
+		}
+
+		// 判定できなかったフィルタ効果は、作成できた種類を記録して次回から使う
+		if (out.kind == MediaKind::UNKNOWN) {
+			learn_media_kind(out.plan, out.tx.used_fallback(out.group_op) ? MediaKind::AUDIO : MediaKind::VIDEO);
+		}
+
+		auto group_obj = out.tx.result(out.group_op);
+		host_set_object_name(edit, group_obj, nullptr);
+		host_set_focus_object(edit, group_obj);
+	}
+}
+
+
+/// オブジェクトメニュー「フィルタ分離（グループ制御）」
+/// 選択中オブジェクトのフィルタ効果部をグループ制御オブジェクトに分離する
+void __cdecl split_filters_for_group_callback(EDIT_SECTION* edit) {
+	split_filters_for_group(edit, false);
+}
+
+
+/// オブジェクトメニュー「フィルタ分離（共通グループ制御）」
+/// 同じフレーム範囲で隣り合うレイヤーのオブジェクトは、共通する末尾のフィルタ効果を1つのグループ制御にまとめて分離する
+void __cdecl split_filters_for_shared_group_callback(EDIT_SECTION* edit) {
+	split_filters_for_group(edit, true);
+}
+
+
+/// オブジェクトメニュー「フィルタを個別に分離」
+/// 選択中オブジェクトのフィルタ効果を、1つずつ別のフィルタ効果オブジェクトに分離する
+void __cdecl explode_filters_callback(EDIT_SECTION* edit) {
+	CommandProfile profile("explode_filters", edit);
+
+	// === 対象オブジェクトの取得 ===
+	LayerOccupancy occupancy(edit);
+	std::vector<TargetObject> targets;
+	if (!take_targets(edit, occupancy, profile, targets)) return;
+
+	// === 解析・エイリアス作成 (並列) ===
+	struct ExplodeOutput {
+		SplitPlan plan;
+		std::vector<std::shared_ptr<const std::string>> filter_aliases;	// フィルタ効果ごとのフィルタ効果オブジェクト
+		std::shared_ptr<const std::string> source_alias;	// 元オブジェクト - 分離フィルタ
+		EditTransaction tx;
+	};
+	std::vector<ExplodeOutput> outputs(targets.size());
+	parallel_for(targets.size(), [&](size_t k) {
+		auto& out = outputs[k];
+		out.plan = make_split_plan(targets[k].alias);
+		if (!out.plan.has_filters()) return;
+		out.filter_aliases.reserve(out.plan.filter_count());
+		for (int i = 0; i < out.plan.filter_count(); i++) {
+			out.filter_aliases.push_back(build_single_filter_alias(out.plan, i));
+		}
+		out.source_alias = build_source_alias(out.plan);
+	});
+
+	// === 変更内容の計画 ===
+	for (size_t k = 0; k < targets.size(); k++) {
+		const auto& lf = targets[k].lf;
+		auto& out = outputs[k];
+		if (!out.plan.has_filters()) continue;
+
+		// 元オブジェクトの下に、フィルタ効果の順で空いているレイヤーをまとめて予約する
+		std::pmr::vector<OBJECT_LAYER_FRAME> filter_lfs(command_resource());
+		filter_lfs.reserve(out.filter_aliases.size());
+		int layer = lf.layer + 1;
+		while (filter_lfs.size() < out.filter_aliases.size()) {
+			layer = occupancy.find_available_layer(layer, lf.start, lf.end);
+			if (layer == -1) break;
+			filter_lfs.push_back({ layer, lf.start, lf.end });
+			occupancy.add(filter_lfs.back(), nullptr);
+			layer++;
+		}
+		if (filter_lfs.size() < out.filter_aliases.size()) {
+			// すべて置けない場合は予約を取り消す
+			for (const auto& filter_lf : filter_lfs) occupancy.remove(filter_lf);
+			continue;
+		}
+
+		// フィルタ効果オブジェクトをすべて作成してから、元オブジェクトを一度だけ置き換える
+		out.tx.reserve(filter_lfs.size() + 1);
+		for (size_t i = 0; i < filter_lfs.size(); i++) {
+			out.tx.create(std::move(out.filter_aliases[i]), filter_lfs[i]);
+		}
+		out.tx.replace(targets[k], std::move(out.source_alias));
+	}
+
+	// === タイムラインへの反映 ===
+	for (size_t k = 0; k < targets.size(); k++) {
+		auto& out = outputs[k];
+
+		// 追加フィルタ効果がない場合
+		if (!out.plan.has_filters()) {
+			report_skipped(Msg::NO_FILTERS, targets[k].lf);
+			continue;
+		}
+
+		if (out.tx.empty() || !out.tx.apply(edit, occupancy)) {
+			report_failed(out.tx.failed_op() == out.plan.filter_count() ? Msg::SOURCE_CREATE_FAILED : Msg::FILTER_CREATE_FAILED, targets[k].lf);
+			continue;
+		}
+
+		for (int i = 0; i < out.plan.filter_count(); i++) {
+			host_set_object_name(edit, out.tx.result(i), nullptr);
+		}
+		host_set_focus_object(edit, out.tx.result(0));
+	}
+}
+
+
+/// 結合コマンドの1オブジェクト分の処理内容
+struct MergeItem {
+	TargetObject selected;		// 結合元 (選択オブジェクト)
+	TargetObject source;		// 結合先 (上のオブジェクト、なければ obj == nullptr)
+	SplitPlan selected_plan;
+	SplitPlan source_plan;
+	int moved = 0;				// 結合するフィルタ効果の数
+	EditTransaction tx;
+};
+
+
+/// 結合コマンドの変更内容を計画する (ホストを呼び出さない)
+/// @param item 処理内容
+/// @param head_only 先頭のフィルタ効果のみを結合するか
+static void plan_merge_item(MergeItem& item, bool head_only) {
+	item.tx = EditTransaction();
+	item.selected_plan = make_split_plan(item.selected.alias, true);
+	if (!item.selected_plan.has_filters() || !item.source.obj) return;
+
+	item.moved = head_only ? 1 : item.selected_plan.filter_count();
+	item.source_plan = make_split_plan(item.source.alias);
+
+	// 結合先を置き換えてから、結合元を残りのフィルタ効果で置き換える (残らなければ削除)
+	item.tx.replace(item.source, build_merged_alias(item.source_plan, item.selected_plan, item.moved));
+	if (item.selected_plan.filter_count() > item.moved) {
+		item.tx.replace(item.selected, build_remaining_alias(item.selected_plan, item.moved));
+	}
+	else {
+		item.tx.remove(item.selected);
+	}
+}
+
+
+/// 選択中オブジェクトのフィルタ効果を上レイヤーのオブジェクトに結合する
+/// @param head_only 先頭のフィルタ効果のみを結合するか
+static void merge_filters(EDIT_SECTION* edit, bool head_only) {
+	CommandProfile profile(head_only ? "merge_head_filters" : "merge_filters", edit);
+
+	// === 対象オブジェクトと結合先の取得 ===
+	LayerOccupancy occupancy(edit);
+	std::vector<TargetObject> targets;
+	if (!take_targets(edit, occupancy, profile, targets)) return;
+
+	std::vector<MergeItem> items(targets.size());
+	for (size_t k = 0; k < targets.size(); k++) {
+		auto& item = items[k];
+		item.selected = std::move(targets[k]);
+
+		// source_objを探す
+		const auto& lf = item.selected.lf;
+		if (auto source_obj = occupancy.find_object_above(lf.layer, lf.start, lf.end)) {
+			item.source = snapshot_object(edit, source_obj);
+		}
+	}
+
+	// === 解析・変更内容の計画 (並列) ===
+	parallel_for(items.size(), [&](size_t k) {
+		plan_merge_item(items[k], head_only);
+	});
+
+	// === タイムラインへの反映 ===
+	// 先に処理したオブジェクトで置き換えられたオブジェクト
+	std::unordered_set<OBJECT_HANDLE> replaced;
+	for (auto& item : items) {
+		// 結合元・結合先が置き換え済みの場合は、現在のタイムラインから取り直して計画し直す
+		if (replaced.count(item.selected.obj) || replaced.count(item.source.obj)) {
+			const auto& lf = item.selected.lf;
+			auto selected_obj = occupancy.find_overlap(lf.layer, lf.start, lf.end);
+			if (!selected_obj) continue;
+			item.selected = snapshot_object(edit, selected_obj);
+			item.source = {};
+			if (auto source_obj = occupancy.find_object_above(lf.layer, lf.start, lf.end)) {
+				item.source = snapshot_object(edit, source_obj);
+			}
+			plan_merge_item(item, head_only);
+		}
+
+		// 追加フィルタ効果がない場合
+		if (!item.selected_plan.has_filters()) {
+			report_skipped(Msg::NO_FILTERS, item.selected.lf);
+			continue;
+		}
+
+		if (!item.source.obj) {
+			report_skipped(Msg::NO_OBJECT_ABOVE, item.selected.lf);
+			continue;
+		}
+
+		// 結合先が受け付けないと分かっているフィルタ効果があれば、ホストを変更する前にスキップする
+		auto check = check_attach(item.source_plan, item.selected_plan, item.moved);
+		if (!check.ok) {
+			report_skipped(Msg::INCOMPATIBLE_FILTERS, item.selected.lf, check.effect_names);
+			continue;
+		}
+
+		bool ok = item.tx.apply(edit, occupancy);
+		replaced.insert(item.tx.replaced_objects().begin(), item.tx.replaced_objects().end());
+		// 結合先の作成 (最初の操作) の結果を記録する
+		learn_attach_result(item.source_plan, item.selected_plan, item.moved, item.tx.failed_op() != 0);
+
+		if (!ok) {
+			if (item.tx.rolled_back()) {
+				if (item.tx.failed_op() == 0) host_set_focus_object(edit, item.selected.obj);
+				report_failed(Msg::MERGE_FAILED_RESTORED, item.selected.lf);
+			}
+			else {
+				report_failed(Msg::SOURCE_CREATE_FAILED, item.selected.lf);
+			}
+			// 作成できなかったエイリアスは、詳細な診断が有効な場合だけ変換して出力する
+			if (g_verbose_diagnostics) {
+				std::wstring merged_alias_w = utf8_to_wide(item.tx.alias(item.tx.failed_op()));
+				logger->verbose(logger, merged_alias_w.c_str());
+			}
+			continue;
+		}
+
+		// 結合元が残っていればそちらを、なければ結合先をフォーカスする
+		auto focus_obj = item.tx.result(1) ? item.tx.result(1) : item.tx.result(0);
+		host_set_focus_object(edit, focus_obj);
+	}
+}
+
+
+/// オブジェクトメニュー「フィルタ結合」
+/// 選択中オブジェクトを上レイヤーのオブジェクトに結合する
+void __cdecl merge_filters_callback(EDIT_SECTION* edit) {
+	merge_filters(edit, false);
+}
+
+
+/// オブジェクトメニュー「上のオブジェクトへ先頭フィルタを結合」
+/// 選択中オブジェクトの"１番目のフィルタのみ"を上レイヤーのオブジェクトに結合する
+void __cdecl merge_head_filters_callback(EDIT_SECTION* edit) {
+	merge_filters(edit, true);
+}
+
+
+/// フォーカス中のオブジェクトの追加フィルタ効果を、選択中オブジェクトすべてに追加する
+/// フォーカス中のオブジェクトは一度だけ解析し、各オブジェクトのエイリアスは解析済みのセクションを並べて作成する
+/// 分割実行では、開始時に取得・解析したフォーカス中のオブジェクトをすべての区切りで使う
+/// @param replace 選択中オブジェクトの追加フィルタ効果を置き換えるか (false なら末尾に追加する)
+static void broadcast_filters(EDIT_SECTION* edit, bool replace) {
+	CommandProfile profile(replace ? "broadcast_replace_filters" : "broadcast_append_filters", edit);
+
+	// === フォーカス中のオブジェクトの解析 ===
+	TargetObject donor;
+	SplitPlan donor_plan;
+	if (g_batch_running) {
+		donor = g_batch->donor();
+		donor_plan = g_batch->donor_plan();
+	}
+	else {
+		auto donor_obj = host_get_focus_object(edit);
+		if (!donor_obj) {
+			logger->info(logger, message(Msg::NO_FOCUS_OBJECT));
+			notify_beep();
+			return;
+		}
+		donor = snapshot_object(edit, donor_obj);
+		donor_plan = make_split_plan(donor.alias, true);
+		if (!donor_plan.has_filters()) {
+			logger->info(logger, message(Msg::NO_FILTERS));
+			notify_beep();
+			return;
+		}
+	}
+
+	// === 対象オブジェクトの取得 (フォーカス中のオブジェクトを除く) ===
+	LayerOccupancy occupancy(edit);
+	std::vector<TargetObject> targets;
+	const bool has_targets = take_targets(edit, occupancy, profile, targets, donor.obj);
+	// 分割実行を始めた場合は、残りの区切りでも同じフォーカス中のオブジェクトを使う
+	if (profile.chunk && !g_batch_running) g_batch->set_donor(donor, donor_plan);
+	if (!has_targets) return;
+
+	// === 解析・エイリアス作成 (並列) ===
+	struct BroadcastOutput {
+		SplitPlan plan;
+		EditTransaction tx;
+	};
+	std::vector<BroadcastOutput> outputs(targets.size());
+	parallel_for(targets.size(), [&](size_t k) {
+		auto& out = outputs[k];
+		out.plan = make_split_plan(targets[k].alias);
+		if (out.plan.parsed().objs.empty()) return;
+		out.tx.replace(targets[k], replace
+			? build_replaced_filters_alias(out.plan, donor_plan)
+			: build_merged_alias(out.plan, donor_plan, donor_plan.filter_count()));
+	});
+
+	// === タイムラインへの反映 ===
+	for (size_t k = 0; k < targets.size(); k++) {
+		auto& out = outputs[k];
+		// エイリアスを解析できなかった場合
+		if (out.tx.empty()) {
+			report_skipped(Msg::NO_FILTERS, targets[k].lf);
+			continue;
+		}
+		auto check = check_attach(out.plan, donor_plan, donor_plan.filter_count());
+		if (!check.ok) {
+			report_skipped(Msg::INCOMPATIBLE_FILTERS, targets[k].lf, check.effect_names);
+			continue;
+		}
+		bool ok = out.tx.apply(edit, occupancy);
+		learn_attach_result(out.plan, donor_plan, donor_plan.filter_count(), ok);
+		if (!ok) {
+			report_failed(out.tx.rolled_back() ? Msg::MERGE_FAILED_RESTORED : Msg::SOURCE_CREATE_FAILED, targets[k].lf);
+		}
+	}
+
+	// 分割実行の区切りでは、フォーカス中だったオブジェクトが移動・削除されていなければフォーカスを戻す
+	if (!profile.chunk || occupancy.find_overlap(donor.lf.layer, donor.lf.start, donor.lf.start) == donor.obj) {
+		host_set_focus_object(edit, donor.obj);
+	}
+}
+
+
+/// オブジェクトメニュー「フォーカス中のフィルタを一括追加」
+/// フォーカス中のオブジェクトの追加フィルタ効果を、選択中オブジェクトの末尾に追加する
+void __cdecl broadcast_append_filters_callback(EDIT_SECTION* edit) {
+	broadcast_filters(edit, false);
+}
+
+
+/// オブジェクトメニュー「フォーカス中のフィルタで一括置換」
+/// 選択中オブジェクトの追加フィルタ効果を、フォーカス中のオブジェクトの追加フィルタ効果で置き換える
+void __cdecl broadcast_replace_filters_callback(EDIT_SECTION* edit) {
+	broadcast_filters(edit, true);
+}
+
+
+/// フィルタ効果をまとめられるオブジェクトの種類
+enum class StackKind {
+	NONE,			// 対象外 (メディアオブジェクトなど)
+	FILTER_OBJECT,	// フィルタオブジェクト
+	FILTER_EFFECT	// フィルタ効果オブジェクト
+};
+
+
+/// オブジェクトがフィルタ効果をまとめる対象かを判定する
+/// @param plan 自身のフィルタ効果を含めて解析した SplitPlan
+static StackKind stack_kind(const SplitPlan& plan) {
+	if (plan.parsed().objs.empty()) return StackKind::NONE;
+	if (plan.is_filter_object) return StackKind::FILTER_OBJECT;
+	if (plan.start_index == 0) return StackKind::FILTER_EFFECT;
+	return StackKind::NONE;
+}
+
+
+/// 「フィルタオブジェクトをまとめる」の1列分の処理内容
+struct StackRun {
+	std::vector<TargetObject> members;	// 上のレイヤーから順
+	std::vector<SplitPlan> plans;		// members と同じ順
+	std::shared_ptr<const std::string> collapsed_alias;
+	EditTransaction tx;
+};
+
+
+/// オブジェクトメニュー「フィルタオブジェクトをまとめる」
+/// 選択中オブジェクトと、同じフレーム範囲で連続するレイヤーのフィルタオブジェクトを1つにまとめる
+void __cdecl collapse_filters_callback(EDIT_SECTION* edit) {
+	CommandProfile profile("collapse_filters", edit);
+
+	// === 対象オブジェクトの取得 ===
+	LayerOccupancy occupancy(edit);
+	std::vector<TargetObject> targets;
+	if (!take_targets(edit, occupancy, profile, targets)) return;
+
+	// === まとめる列を探す ===
+	std::unordered_set<OBJECT_HANDLE> visited;
+	std::vector<StackRun> runs;
+	for (const auto& target : targets) {
+		if (visited.count(target.obj)) continue;
+		SplitPlan plan = make_split_plan(target.alias, true);
+		const StackKind kind = stack_kind(plan);
+		if (kind == StackKind::NONE) continue;
+		visited.insert(target.obj);
+
+		// layer に同じフレーム範囲・同じ種類のオブジェクトがあれば取得する
+		const auto& range = target.lf;
+		auto find_member = [&](int layer, TargetObject& member, SplitPlan& member_plan) {
+			OBJECT_LAYER_FRAME lf;
+			auto obj = occupancy.find_overlap(layer, range.start, range.end, &lf);
+			if (!obj || lf.start != range.start || lf.end != range.end || visited.count(obj)) return false;
+			member = snapshot_object(edit, obj);
+			member_plan = make_split_plan(member.alias, true);
+			if (stack_kind(member_plan) != kind) return false;
+			visited.insert(obj);
+			return true;
+		};
+
+		StackRun run;
+		TargetObject member;
+		SplitPlan member_plan;
+		for (int layer = range.layer - 1; layer >= 0 && find_member(layer, member, member_plan); layer--) {
+			run.members.push_back(std::move(member));
+			run.plans.push_back(std::move(member_plan));
+		}
+		std::reverse(run.members.begin(), run.members.end());
+		std::reverse(run.plans.begin(), run.plans.end());
+		run.members.push_back(target);
+		run.plans.push_back(std::move(plan));
+		for (int layer = range.layer + 1; layer < SAFE_LAYER_LIMIT && find_member(layer, member, member_plan); layer++) {
+			run.members.push_back(std::move(member));
+			run.plans.push_back(std::move(member_plan));
+		}
+		if (run.members.size() >= 2) runs.push_back(std::move(run));
+	}
+
+	if (runs.empty()) {
+		// 分割実行の区切りでは、他の区切りでまとめられていることがあるため通知しない
+		if (!profile.chunk) {
+			logger->info(logger, message(Msg::NO_COLLAPSE_TARGET));
+			notify_beep();
+		}
+		return;
+	}
+
+	// === エイリアス作成 (並列) ===
+	parallel_for(runs.size(), [&](size_t k) {
+		auto& run = runs[k];
+		std::vector<const SplitPlan*> plans;
+		plans.reserve(run.plans.size());
+		for (const auto& plan : run.plans) plans.push_back(&plan);
+		run.collapsed_alias = build_collapsed_alias(plans);
+	});
+
+	// === タイムラインへの反映 ===
+	for (auto& run : runs) {
+		// 一番上のオブジェクトをまとめたもので置き換え、それ以外を削除する
+		run.tx.replace(run.members[0], std::move(run.collapsed_alias));
+		for (size_t i = 1; i < run.members.size(); i++) {
+			run.tx.remove(run.members[i]);
+		}
+
+		if (!run.tx.apply(edit, occupancy)) {
+			report_failed(run.tx.rolled_back() ? Msg::MERGE_FAILED_RESTORED : Msg::SOURCE_CREATE_FAILED, run.members[0].lf);
+			continue;
+		}
+		host_set_focus_object(edit, run.tx.result(0));
+	}
+}
+
+
+/// 書式 format (%ls を1つ含む翻訳済みのメッセージ) に text を埋め込んでログに出力する
+/// (text の長さに制限がないため、バッファは text に合わせて確保する)
+static void log_info_with(Msg format, const wchar_t* text) {
+	std::vector<wchar_t> line(std::wcslen(message(format)) + std::wcslen(text) + 1);
+	std::swprintf(line.data(), line.size(), message(format), text);
+	logger->info(logger, line.data());
+}
+
+
+/// 対象範囲を切り替える
+/// @param scope 対象範囲
+/// @param name 対象範囲の名前
+static void set_target_scope(TargetScope scope, Msg name) {
+	g_target_scope = scope;
+	log_info_with(Msg::SCOPE_CHANGED, message(name));
+}
+
+
+/// 編集メニュー「対象範囲 > 選択オブジェクト」
+void __cdecl scope_selection_callback(EDIT_SECTION*) {
+	set_target_scope(TargetScope::SELECTION, Msg::SCOPE_SELECTION);
+}
+
+
+/// 編集メニュー「対象範囲 > フォーカス中のレイヤー」
+void __cdecl scope_layer_callback(EDIT_SECTION*) {
+	set_target_scope(TargetScope::LAYER, Msg::SCOPE_LAYER);
+}
+
+
+/// 編集メニュー「対象範囲 > 選択範囲のフレーム」
+void __cdecl scope_frame_range_callback(EDIT_SECTION*) {
+	set_target_scope(TargetScope::FRAME_RANGE, Msg::SCOPE_FRAME_RANGE);
+}
+
+
+/// 編集メニュー「対象範囲 > シーン全体」
+void __cdecl scope_scene_callback(EDIT_SECTION*) {
+	set_target_scope(TargetScope::SCENE, Msg::SCOPE_SCENE);
+}
+
+
+/// 編集メニュー「指定フィルタをフォーカス中のオブジェクトから設定」
+/// フォーカス中のオブジェクトの追加フィルタ効果のエフェクト名を、「フィルタ分離（指定フィルタのみ）」の条件にする
+/// (環境変数 SPLIT_FILTERS_MATCH の条件を、AviUtl2 を再起動せずに置き換える)
+void __cdecl set_match_from_focus_callback(EDIT_SECTION* edit) {
+	auto obj = host_get_focus_object(edit);
+	if (!obj) {
+		logger->info(logger, message(Msg::NO_FOCUS_OBJECT));
+		notify_beep();
+		return;
+	}
+	const char* alias = host_get_object_alias(edit, obj);
+	const SplitPlan plan = make_split_plan(std::make_shared<const std::string>(alias ? alias : ""), true);
+	if (!plan.has_filters()) {
+		logger->info(logger, message(Msg::NO_FILTERS));
+		notify_beep();
+		return;
+	}
+
+	// 同じエフェクト名は1つにまとめ、';' 区切りで並べる
+	std::string patterns;
+	std::unordered_set<std::string_view> seen;
+	for (int i = plan.start_index; i < (int)plan.parsed().objs.size(); i++) {
+		const std::string_view name = plan.parsed().objs[i].effect_name;
+		if (!seen.insert(name).second) continue;
+		if (!patterns.empty()) patterns += ';';
+		patterns += name;
+	}
+	g_split_match = EffectNameFilter(patterns);
+
+	log_info_with(Msg::MATCH_SET, utf8_to_wide(patterns).c_str());
+}
+
+
+/// 編集メニュー「結合の互換情報をリセット」
+/// 結合・一括追加で学習した、追加先が受け付けないフィルタ効果の記録を消す
+void __cdecl reset_attach_table_callback(EDIT_SECTION*) {
+	reset_attach_table();
+	logger->info(logger, message(Msg::ATTACH_TABLE_RESET));
+}
+
+
+/// オブジェクトメニューから callback を実行する (対象範囲は選択中オブジェクト)
+void run_from_object_menu(void (__cdecl *callback)(EDIT_SECTION*), EDIT_SECTION* edit) {
+	g_from_object_menu = true;
+	callback(edit);
+	g_from_object_menu = false;
+}
+
+
+/// コマンド名と処理の対応 (CommandProfile に渡す名前)
+/// 記録の再生と、分割実行の区切りの実行に使う
+static const struct {
+	const char* name;
+	void (__cdecl *callback)(EDIT_SECTION*);
+} COMMANDS[] = {
+	{ "split_filters", split_filters_callback },
+	{ "split_matching_filters", split_matching_filters_callback },
+	{ "split_filters_for_group", split_filters_for_group_callback },
+	{ "split_filters_for_shared_group", split_filters_for_shared_group_callback },
+	{ "explode_filters", explode_filters_callback },
+	{ "merge_filters", merge_filters_callback },
+	{ "merge_head_filters", merge_head_filters_callback },
+	{ "broadcast_append_filters", broadcast_append_filters_callback },
+	{ "broadcast_replace_filters", broadcast_replace_filters_callback },
+	{ "collapse_filters", collapse_filters_callback },
+};
+
+
+/// 名前でコマンドを実行する
+/// @return コマンドを実行したか (未知のコマンドなら false)
+static bool run_command(const char* command, EDIT_SECTION* edit) {
+	for (const auto& entry : COMMANDS) {
+		if (std::strcmp(command, entry.name) != 0) continue;
+		entry.callback(edit);
+		return true;
+	}
+	return false;
+}
+
+
+/// 記録したコマンドを、記録時の対象範囲・条件で実行する
+/// @param edit 記録を再生する EDIT_SECTION (TraceReplay::edit())
+/// @return コマンドを実行したか (未知のコマンドなら false)
+/// 対象範囲・条件は、再生の後に元に戻す
+bool replay_command(const TraceCommand& command, EDIT_SECTION* edit) {
+	const TargetScope scope = g_target_scope;
+	const EffectNameFilter match = g_split_match;
+	g_target_scope = (TargetScope)command.scope;
+	g_split_match = EffectNameFilter(command.match);
+	g_replaying = true;
+	const bool ran = run_command(command.name.c_str(), edit);
+	g_replaying = false;
+	g_target_scope = scope;
+	g_split_match = match;
+	return ran;
+}
+
+
+// --- 分割実行 ---
+// 区切りはタイマー (schedule_deferred_call) から call_edit_section で1つずつ実行する
+// 中止の操作も編集処理として実行されるため、区切りの途中で中止されることはない
+
+/// 次の区切りを実行するまでの間隔 (ミリ秒、この間に画面の更新や操作が行われる)
+const unsigned int BATCH_INTERVAL_MS = 10;
+
+/// 進み具合を最後に出力した時刻
+static std::chrono::steady_clock::time_point g_batch_last_progress;
+/// 進み具合を出力する間隔
+const auto BATCH_PROGRESS_INTERVAL = std::chrono::milliseconds(500);
+
+
+/// 分割実行をやめる (予約した区切りは実行しない)
+/// 分割実行全体で集計したスキップ・失敗はここで出力する
+static void end_batch() {
+	cancel_deferred_call();
+	g_batch.reset();
+	g_diagnostics.flush(logger);
+}
+
+
+/// 分割実行の区切りを1つ実行する
+static void __cdecl batch_chunk_callback(EDIT_SECTION* edit) {
+	if (!g_batch) return;
+	const size_t done = g_batch->done();
+	g_batch_running = true;
+	run_command(g_batch->command().c_str(), edit);
+	g_batch_running = false;
+
+	// 対象を取得する前にコマンドが終わった場合 (条件の解除など) は、同じ区切りを繰り返さないよう中止する
+	if (g_batch && g_batch->done() == done) {
+		wchar_t buf[160];
+		std::swprintf(buf, 160, message(Msg::BATCH_CANCELLED), g_batch->done(), g_batch->total());
+		logger->info(logger, buf);
+		end_batch();
+	}
+}
+
+
+/// 予約した区切りを実行する
+static void batch_deferred_call() {
+	if (!g_batch) return;
+
+	// ホストが他の編集処理中で実行できなければ、次の間隔でやり直す
+	if (!edit_handle->call_edit_section(batch_chunk_callback) && g_batch) {
+		schedule_deferred_call(BATCH_INTERVAL_MS, batch_deferred_call);
+	}
+}
+
+
+/// 区切りの処理時間を記録し、次の区切りを予約する (最後の区切りなら完了を通知する)
+/// @param elapsed_ms 区切りの処理時間
+static void finish_batch_chunk(double elapsed_ms) {
+	wchar_t buf[160];
+	g_batch->record_chunk(elapsed_ms);
+	if (g_batch->finished()) {
+		std::swprintf(buf, 160, message(Msg::BATCH_FINISHED), g_batch->total());
+		logger->info(logger, buf);
+		end_batch();
+		return;
+	}
+
+	auto now = std::chrono::steady_clock::now();
+	if (now - g_batch_last_progress >= BATCH_PROGRESS_INTERVAL) {
+		g_batch_last_progress = now;
+		std::swprintf(buf, 160, message(Msg::BATCH_PROGRESS), g_batch->done(), g_batch->total());
+		logger->info(logger, buf);
+	}
+
+	if (!schedule_deferred_call(BATCH_INTERVAL_MS, batch_deferred_call)) {
+		std::swprintf(buf, 160, message(Msg::BATCH_CANCELLED), g_batch->done(), g_batch->total());
+		logger->warn(logger, buf);
+		end_batch();
+	}
+}
+
+
+/// 編集メニュー「分割実行を中止」
+/// 実行中の分割実行を、次の区切りから中止する (処理済みの区切りはそのまま残る)
+void __cdecl cancel_batch_callback(EDIT_SECTION*) {
+	if (!g_batch) {
+		logger->info(logger, message(Msg::BATCH_IDLE));
+		return;
+	}
+	wchar_t buf[160];
+	std::swprintf(buf, 160, message(Msg::BATCH_CANCELLED), g_batch->done(), g_batch->total());
+	logger->info(logger, buf);
+	end_batch();
+}
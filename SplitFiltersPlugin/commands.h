@@ -0,0 +1,77 @@
+#pragma once
+#include "util.h"
+#include "thread_pool.h"
+#include "alias_cache.h"
+#include "timeline.h"
+#include "transaction.h"
+#include "host.h"
+#include "profiler.h"
+#include "arena.h"
+#include "alloc_stats.h"
+#include "trace.h"
+#include "batch.h"
+#include "compat.h"
+#include "diag.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <unordered_set>
+
+// --- コマンド ---
+// オブジェクトメニュー・編集メニューから呼び出す処理と、記録の再生・分割実行
+// Windows の API は util.h を通して使うため、プラグイン外 (記録の再生・テスト) でもビルドできる
+
+// --- 外部変数宣言 ---
+extern EDIT_HANDLE* edit_handle;
+extern LOG_HANDLE* logger;
+extern CONFIG_HANDLE* config;
+extern EffectNameFilter g_split_match;
+extern bool g_verbose_diagnostics;
+
+
+// --- メニューに登録する処理 ---
+void __cdecl split_filters_callback(EDIT_SECTION* edit);
+void __cdecl split_matching_filters_callback(EDIT_SECTION* edit);
+void __cdecl split_filters_for_group_callback(EDIT_SECTION* edit);
+void __cdecl split_filters_for_shared_group_callback(EDIT_SECTION* edit);
+void __cdecl explode_filters_callback(EDIT_SECTION* edit);
+void __cdecl merge_filters_callback(EDIT_SECTION* edit);
+void __cdecl merge_head_filters_callback(EDIT_SECTION* edit);
+void __cdecl broadcast_append_filters_callback(EDIT_SECTION* edit);
+void __cdecl broadcast_replace_filters_callback(EDIT_SECTION* edit);
+void __cdecl collapse_filters_callback(EDIT_SECTION* edit);
+void __cdecl scope_selection_callback(EDIT_SECTION* edit);
+void __cdecl scope_layer_callback(EDIT_SECTION* edit);
+void __cdecl scope_frame_range_callback(EDIT_SECTION* edit);
+void __cdecl scope_scene_callback(EDIT_SECTION* edit);
+void __cdecl cancel_batch_callback(EDIT_SECTION* edit);
+void __cdecl set_match_from_focus_callback(EDIT_SECTION* edit);
+void __cdecl reset_attach_table_callback(EDIT_SECTION* edit);
+
+/// 編集メニューの「対象範囲」によらず、選択中オブジェクトを対象に callback を実行する
+void run_from_object_menu(void (__cdecl *callback)(EDIT_SECTION*), EDIT_SECTION* edit);
+
+/// オブジェクトメニューに登録する処理 (選択中オブジェクトだけを対象にする)
+template<void (__cdecl *Callback)(EDIT_SECTION*)>
+void __cdecl object_menu(EDIT_SECTION* edit) {
+	run_from_object_menu(Callback, edit);
+}
+
+
+// --- コマンドの集計 ---
+/// コマンド1回分のホスト呼び出しとヒープ確保の集計 (テスト用)
+struct CommandStats {
+	const char* command = nullptr;
+	size_t targets = 0;						// 対象オブジェクトの数
+	HostCallCounts host_calls;
+	uint64_t host_call_budget = UINT64_MAX;	// ホスト呼び出しの予算 (予算のないコマンドは UINT64_MAX)
+	AllocStats allocs = {};					// ヒープ確保 (計測した場合のみ)
+	uint64_t alloc_budget = UINT64_MAX;		// ヒープ確保の回数の予算
+};
+
+/// 最後に終了したコマンドの集計
+const CommandStats& last_command_stats();
+
+
+// --- 記録の再生 ---
+bool replay_command(const TraceCommand& command, EDIT_SECTION* edit);
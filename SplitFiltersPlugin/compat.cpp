@@ -0,0 +1,154 @@
+#include "compat.h"
+#include <algorithm>
+#include <array>
+#include <unordered_map>
+
+/// フィルタ効果と追加先の種類ごとの、ホストの結果
+enum class AttachState : uint8_t {
+	UNKNOWN,
+	ACCEPTED,	// 受け付けた
+	REJECTED	// ATTACH_REJECT_FAILURES 回受け付けなかった
+};
+
+/// フィルタ効果と追加先の種類ごとの記録
+struct AttachRecord {
+	AttachState state = AttachState::UNKNOWN;
+	uint8_t failures = 0;	// 受け付けなかった回数 (受け付けたら 0 に戻す)
+};
+
+/// 受け付けなかったが、原因のフィルタ効果を1つに絞れなかった組み合わせ (名前順)
+struct RejectedSet {
+	std::vector<std::string> names;
+	int failures = 0;
+};
+
+/// エフェクト名 -> 追加先の種類ごとの記録
+static std::unordered_map<std::string, std::array<AttachRecord, (size_t)AttachTarget::COUNT>> g_attach_records;
+
+/// 受け付けなかった組み合わせ (追加先の種類ごと)
+/// 組み合わせのいずれかが受け付けられたら取り除き、残りが1つになればその失敗回数に加える
+static std::vector<RejectedSet> g_rejected_sets[(size_t)AttachTarget::COUNT];
+
+
+AttachTarget classify_attach_target(const SplitPlan& plan) {
+	const auto& objs = plan.parsed().objs;
+	if (objs.empty()) return AttachTarget::OTHER;
+	if (has_output_section(objs)) {
+		return has_effect_category(objs[1].effect_id, EFFECT_AUDIO) ? AttachTarget::AUDIO : AttachTarget::MEDIA;
+	}
+	if (has_effect_category(objs[0].effect_id, EFFECT_FILTER_OBJECT)) return AttachTarget::FILTER_OBJECT;
+	if (has_effect_category(objs[0].effect_id, EFFECT_GROUP)) {
+		return has_effect_category(objs[0].effect_id, EFFECT_AUDIO) ? AttachTarget::AUDIO : AttachTarget::GROUP;
+	}
+	return AttachTarget::OTHER;
+}
+
+
+/// エフェクト名の追加先の種類に対する結果を返す
+static AttachState attach_state(const std::string& name, AttachTarget target) {
+	auto it = g_attach_records.find(name);
+	return it != g_attach_records.end() ? it->second[(size_t)target].state : AttachState::UNKNOWN;
+}
+
+
+/// エフェクト名の追加先の種類に対する失敗回数を加え、ATTACH_REJECT_FAILURES 回に達したら受け付けないものとする
+static void add_failures(const std::string& name, AttachTarget target, int failures) {
+	auto& record = g_attach_records[name][(size_t)target];
+	record.failures = (uint8_t)std::min(record.failures + failures, ATTACH_REJECT_FAILURES);
+	if (record.failures >= ATTACH_REJECT_FAILURES) record.state = AttachState::REJECTED;
+}
+
+
+/// 追加するフィルタ効果のうち、受け付けた記録のないものの名前を重複なく名前順で返す
+static std::vector<std::string> unconfirmed_names(const SplitPlan& src, int filter_count, AttachTarget target) {
+	const auto& objs = src.parsed().objs;
+	std::vector<std::string> names;
+	for (int i = src.start_index; i < src.start_index + filter_count && i < (int)objs.size(); i++) {
+		std::string name(objs[i].effect_name);
+		if (name.empty() || attach_state(name, target) == AttachState::ACCEPTED) continue;
+		names.push_back(std::move(name));
+	}
+	std::sort(names.begin(), names.end());
+	names.erase(std::unique(names.begin(), names.end()), names.end());
+	return names;
+}
+
+
+AttachCheck check_attach(const SplitPlan& dest, const SplitPlan& src, int filter_count) {
+	AttachCheck check;
+	const AttachTarget target = classify_attach_target(dest);
+	const MediaKind dest_kind = classify_media_kind(dest);
+	auto reject = [&](std::string_view name) {
+		if (!check.effect_names.empty()) check.effect_names += ", ";
+		check.effect_names += name;
+		check.ok = false;
+	};
+
+	const auto names = unconfirmed_names(src, filter_count, target);
+	for (const auto& name : names) {
+		if (attach_state(name, target) == AttachState::REJECTED) {
+			reject(name);
+			continue;
+		}
+		// 映像/音声の判定が分かっていて異なるもの
+		const MediaKind kind = lookup_media_kind(name);
+		if (dest_kind != MediaKind::UNKNOWN && kind != MediaKind::UNKNOWN && kind != dest_kind) reject(name);
+	}
+	if (!check.ok) return check;
+
+	// 受け付けなかった組み合わせをすべて含むもの
+	for (const auto& set : g_rejected_sets[(size_t)target]) {
+		if (set.failures < ATTACH_REJECT_FAILURES) continue;
+		if (std::includes(names.begin(), names.end(), set.names.begin(), set.names.end())) {
+			for (const auto& name : set.names) reject(name);
+			break;
+		}
+	}
+	return check;
+}
+
+
+void learn_attach_result(const SplitPlan& dest, const SplitPlan& src, int filter_count, bool accepted) {
+	const AttachTarget target = classify_attach_target(dest);
+	auto names = unconfirmed_names(src, filter_count, target);
+	auto& sets = g_rejected_sets[(size_t)target];
+
+	if (!accepted) {
+		// 受け付けた記録のあるものだけの組み合わせでは、原因が分からないため記録しない
+		if (names.size() == 1) {
+			add_failures(names[0], target, 1);
+		}
+		else if (names.size() > 1) {
+			auto it = std::find_if(sets.begin(), sets.end(), [&](const RejectedSet& set) { return set.names == names; });
+			if (it == sets.end()) it = sets.insert(sets.end(), RejectedSet{ std::move(names) });
+			it->failures++;
+		}
+		return;
+	}
+
+	for (const auto& name : names) {
+		g_attach_records[name][(size_t)target] = { AttachState::ACCEPTED, 0 };
+	}
+	if (names.empty()) return;
+
+	// 受け付けたものを組み合わせから取り除き、残りが1つならその組み合わせの失敗回数を加える
+	for (auto it = sets.begin(); it != sets.end(); ) {
+		auto& set_names = it->names;
+		set_names.erase(std::remove_if(set_names.begin(), set_names.end(), [&](const std::string& name) {
+			return std::binary_search(names.begin(), names.end(), name);
+		}), set_names.end());
+		if (set_names.size() <= 1) {
+			if (set_names.size() == 1) add_failures(set_names.front(), target, it->failures);
+			it = sets.erase(it);
+		}
+		else {
+			++it;
+		}
+	}
+}
+
+
+void reset_attach_table() {
+	g_attach_records.clear();
+	for (auto& sets : g_rejected_sets) sets.clear();
+}
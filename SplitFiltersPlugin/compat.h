@@ -0,0 +1,47 @@
+#pragma once
+#include "alias.h"
+#include <string>
+
+// --- フィルタ効果の追加先との互換表 ---
+// 結合・一括追加の前に、追加するフィルタ効果を追加先のオブジェクトの種類にホストが受け付けるかを予測する
+// 映像/音声の判定が異なるものは受け付けないとみなし、それ以外はホストの結果から学習する
+// 一度の失敗は別の原因 (位置の重なりなど) のこともあるため、ATTACH_REJECT_FAILURES 回失敗するまでは受け付けないとみなさない
+// 更新はホストを呼び出すスレッドからのみ行う
+
+/// 受け付けないとみなすまでに、ホストが受け付けなかった回数
+const int ATTACH_REJECT_FAILURES = 2;
+
+/// フィルタ効果の追加先のオブジェクトの種類
+enum class AttachTarget : uint8_t {
+	MEDIA,			// 映像のメディアオブジェクト
+	AUDIO,			// 音声のメディアオブジェクト・グループ制御(音声)
+	FILTER_OBJECT,	// フィルタオブジェクト
+	GROUP,			// グループ制御
+	OTHER,			// その他の特殊メディアオブジェクト・判定できないもの
+	COUNT
+};
+
+/// 追加先のオブジェクトの種類を判定する
+/// @param plan: 追加先の解析済みの SplitPlan
+AttachTarget classify_attach_target(const SplitPlan& plan);
+
+/// 予測の結果
+struct AttachCheck {
+	bool ok = true;				// 受け付けない可能性が高いものがなければ true
+	std::string effect_names;	// 受け付けないと予測したフィルタ効果の名前 (複数なら ", " 区切り)
+};
+
+/// 追加するフィルタ効果を追加先が受け付けるかを予測する (ホストを呼び出さない)
+/// @param dest: 追加先の SplitPlan
+/// @param src: 追加元の SplitPlan (先頭のフィルタ効果から filter_count 個を追加する)
+/// @param filter_count: 追加するフィルタ効果の数
+AttachCheck check_attach(const SplitPlan& dest, const SplitPlan& src, int filter_count);
+
+/// ホストが追加先の作成を受け付けたかを記録する
+/// 受け付けなかった場合、受け付けた記録のないフィルタ効果が1つだけならそれの、複数ならその組み合わせの失敗回数を数える
+/// 受け付けた場合は、そのフィルタ効果の失敗回数を取り消す
+/// @param accepted: 追加先の作成に成功したか
+void learn_attach_result(const SplitPlan& dest, const SplitPlan& src, int filter_count, bool accepted);
+
+/// 記録したホストの結果をすべて消す (ホストのバージョンやフィルタ効果のスクリプトが変わった場合など)
+void reset_attach_table();
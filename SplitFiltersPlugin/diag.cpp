@@ -0,0 +1,106 @@
+#include "diag.h"
+#include "util.h"
+#include <algorithm>
+#include <cwchar>
+
+/// Msg の順に並べた翻訳前のメッセージ
+static const wchar_t* const MESSAGE_SOURCES[] = {
+	L"選択オブジェクトがありません。",
+	L"対象範囲にオブジェクトがありません。",
+	L"抽出できるフィルタ効果がありません。",
+	L"条件に一致するフィルタ効果がありません。",
+	L"分離するフィルタ効果の条件が設定されていません。",
+	L"上のオブジェクトが存在しません。",
+	L"フォーカス中のオブジェクトがありません。",
+	L"まとめられるフィルタオブジェクトがありません。",
+	L"結合先に追加できないフィルタ効果が含まれるため、スキップしました。",
+	L"元オブジェクトの作成に失敗しました。",
+	L"フィルタ効果オブジェクトの作成に失敗しました。",
+	L"グループ制御オブジェクトの作成に失敗しました。",
+	L"フィルタ結合に失敗しました。元オブジェクトを復旧しました。",
+	L"分割実行中のコマンドがあります。完了するか中止してから実行してください。",
+	L"対象が多いため、%zu 個のオブジェクトを分割して実行します。",
+	L"処理中: %zu / %zu 個",
+	L"分割実行が完了しました。(%zu 個)",
+	L"分割実行を中止しました。(%zu / %zu 個)",
+	L"実行中の分割実行はありません。",
+	L"対象範囲: %ls",
+	L"選択オブジェクト",
+	L"フォーカス中のレイヤー",
+	L"選択範囲のフレーム",
+	L"シーン全体",
+	L"分離するフィルタ効果の条件: %ls",
+	L"結合の互換情報をリセットしました。",
+	L"%ls (%zu 個: %ls)",
+};
+static_assert(sizeof(MESSAGE_SOURCES) / sizeof(MESSAGE_SOURCES[0]) == (size_t)Msg::COUNT, "MESSAGE_SOURCES は Msg と同じ数だけ並べてください");
+
+/// 翻訳済みのメッセージ (cache_messages の前は空)
+static std::array<std::wstring, (size_t)Msg::COUNT> g_messages;
+
+
+void cache_messages(CONFIG_HANDLE* config) {
+	for (size_t i = 0; i < g_messages.size(); i++) {
+		g_messages[i] = config->translate(config, MESSAGE_SOURCES[i]);
+	}
+}
+
+
+const wchar_t* message(Msg id) {
+	const auto& cached = g_messages[(size_t)id];
+	return cached.empty() ? MESSAGE_SOURCES[(size_t)id] : cached.c_str();
+}
+
+
+void Diagnostics::add(Msg id, DiagLevel level, const OBJECT_LAYER_FRAME& lf, std::string_view detail) {
+	auto& entry = entries[(size_t)id];
+	entry.count++;
+	entry.level = std::max(entry.level, level);
+	if (entry.locations.size() < DIAG_MAX_LOCATIONS) entry.locations.push_back(lf);
+	if (!detail.empty() && entry.details.size() < DIAG_MAX_LOCATIONS
+		&& std::find(entry.details.begin(), entry.details.end(), detail) == entry.details.end()) {
+		entry.details.emplace_back(detail);
+	}
+	total++;
+}
+
+
+void Diagnostics::flush(LOG_HANDLE* logger) {
+	if (total == 0) return;
+	bool beep = false;
+	for (size_t i = 0; i < entries.size(); i++) {
+		auto& entry = entries[i];
+		if (entry.count == 0) continue;
+
+		// メッセージ (内容) (件数: L<レイヤー>:<開始フレーム>, ...)
+		std::wstring text = message((Msg)i);
+		if (!entry.details.empty()) {
+			text += L" (";
+			for (size_t d = 0; d < entry.details.size(); d++) {
+				if (d > 0) text += L" / ";
+				text += utf8_to_wide(entry.details[d]);
+			}
+			text += L")";
+		}
+		std::wstring locations;
+		wchar_t buf[32];
+		for (const auto& lf : entry.locations) {
+			if (!locations.empty()) locations += L", ";
+			std::swprintf(buf, 32, L"L%d:%d", lf.layer + 1, lf.start);
+			locations += buf;
+		}
+		if (entry.count > entry.locations.size()) locations += L", ...";
+
+		std::vector<wchar_t> line(text.size() + locations.size() + std::wcslen(message(Msg::DIAG_SUMMARY)) + 32);
+		std::swprintf(line.data(), line.size(), message(Msg::DIAG_SUMMARY), text.c_str(), entry.count, locations.c_str());
+		switch (entry.level) {
+		case DiagLevel::VERBOSE: logger->verbose(logger, line.data()); break;
+		case DiagLevel::INFO: logger->info(logger, line.data()); break;
+		case DiagLevel::WARN: logger->warn(logger, line.data()); break;
+		}
+		beep |= entry.level != DiagLevel::VERBOSE;
+		entry = Entry();
+	}
+	total = 0;
+	if (beep) notify_beep();
+}
@@ -0,0 +1,85 @@
+#pragma once
+#include "host_api.h"
+#include <array>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// --- ログのメッセージと、コマンド中の診断の集計 ---
+// メッセージは InitializeConfig で一度だけ翻訳して保持する
+// オブジェクトごとのスキップ・失敗はコマンドの実行中に集計し、終了時 (分割実行なら全体の終了時) に理由ごとに1行ずつ出力する
+
+/// 集計に残すオブジェクトの位置の数 (理由ごと)
+const size_t DIAG_MAX_LOCATIONS = 5;
+
+/// ログのメッセージ
+/// メッセージを追加する場合は Msg と MESSAGE_SOURCES (diag.cpp) に1行ずつ追加する
+enum class Msg : uint8_t {
+	NO_SELECTION,
+	NO_TARGET_IN_SCOPE,
+	NO_FILTERS,
+	NO_MATCH,
+	NO_MATCH_CONDITION,
+	NO_OBJECT_ABOVE,
+	NO_FOCUS_OBJECT,
+	NO_COLLAPSE_TARGET,
+	INCOMPATIBLE_FILTERS,
+	SOURCE_CREATE_FAILED,
+	FILTER_CREATE_FAILED,
+	GROUP_CREATE_FAILED,
+	MERGE_FAILED_RESTORED,
+	BATCH_BUSY,
+	BATCH_START,
+	BATCH_PROGRESS,
+	BATCH_FINISHED,
+	BATCH_CANCELLED,
+	BATCH_IDLE,
+	SCOPE_CHANGED,
+	SCOPE_SELECTION,
+	SCOPE_LAYER,
+	SCOPE_FRAME_RANGE,
+	SCOPE_SCENE,
+	MATCH_SET,
+	ATTACH_TABLE_RESET,
+	DIAG_SUMMARY,
+	COUNT
+};
+
+/// メッセージを翻訳して保持する
+void cache_messages(CONFIG_HANDLE* config);
+
+/// 翻訳済みのメッセージ (翻訳前なら元の文字列)
+const wchar_t* message(Msg id);
+
+
+/// 集計した診断を出力するレベル
+enum class DiagLevel : uint8_t {
+	VERBOSE,	// verbose ログのみ (音は鳴らさない)
+	INFO,		// スキップ
+	WARN		// 失敗
+};
+
+/// コマンド中のスキップ・失敗の集計
+class Diagnostics {
+public:
+	/// スキップ・失敗を1件追加する
+	/// @param lf 対象オブジェクトの位置
+	/// @param detail メッセージに添える内容 (UTF-8、異なるものを DIAG_MAX_LOCATIONS 個まで残す)
+	void add(Msg id, DiagLevel level, const OBJECT_LAYER_FRAME& lf, std::string_view detail = {});
+
+	bool empty() const { return total == 0; }
+
+	/// 理由ごとに件数と先頭の位置をログに出力し、集計を空にする
+	/// VERBOSE 以外があれば一度だけ音を鳴らす
+	void flush(LOG_HANDLE* logger);
+
+private:
+	struct Entry {
+		size_t count = 0;
+		DiagLevel level = DiagLevel::VERBOSE;	// 追加されたうち最も高いレベル
+		std::vector<OBJECT_LAYER_FRAME> locations;
+		std::vector<std::string> details;
+	};
+	std::array<Entry, (size_t)Msg::COUNT> entries;
+	size_t total = 0;
+};
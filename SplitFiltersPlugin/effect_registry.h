@@ -0,0 +1,151 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <string_view>
+
+// --- 既知のエフェクトの登録表 ---
+// エフェクトを追加する場合は EffectId と EFFECT_REGISTRY に1行ずつ追加する
+// (判定は分類フラグで行うため、呼び出し側の変更は不要)
+
+/// 既知のエフェクト
+enum class EffectId : uint8_t {
+	UNKNOWN = 0,
+	STANDARD_DRAW,
+	AUDIO_PLAYBACK,
+	VIDEO_PLAYBACK,
+	BASIC_OUTPUT,
+	PARTICLE_OUTPUT,
+	FILTER_OBJECT,
+	PARTIAL_FILTER,
+	GROUP,
+	GROUP_AUDIO,
+	CAMERA,
+	TIME_CONTROL,
+	SCENE_CHANGE,
+};
+
+/// エフェクトの分類フラグ
+enum EffectCategory : uint32_t {
+	EFFECT_OUTPUT_SECTION		= 1 << 0,	// 出力切り替えセクション
+	EFFECT_NON_OUTPUT_OBJECT	= 1 << 1,	// 出力切り替えセクションを持たない特殊メディアオブジェクト
+	EFFECT_FILTER_OBJECT		= 1 << 2,	// フィルタオブジェクト
+	EFFECT_GROUP				= 1 << 3,	// グループ制御
+	EFFECT_AUDIO				= 1 << 4,	// 音声を扱う (出力切り替えセクションか特殊メディアオブジェクトのみ)
+};
+
+struct EffectInfo {
+	EffectId id;
+	std::string_view name;
+	uint32_t categories;
+};
+
+static constexpr EffectInfo EFFECT_REGISTRY[] = {
+	{ EffectId::STANDARD_DRAW,		u8"標準描画",				EFFECT_OUTPUT_SECTION },
+	{ EffectId::AUDIO_PLAYBACK,		u8"音声再生",				EFFECT_OUTPUT_SECTION | EFFECT_AUDIO },
+	{ EffectId::VIDEO_PLAYBACK,		u8"映像再生",				EFFECT_OUTPUT_SECTION },
+	{ EffectId::BASIC_OUTPUT,		u8"基本出力",				EFFECT_OUTPUT_SECTION },
+	{ EffectId::PARTICLE_OUTPUT,	u8"パーティクル出力",		EFFECT_OUTPUT_SECTION },
+	{ EffectId::FILTER_OBJECT,		u8"フィルタオブジェクト",	EFFECT_NON_OUTPUT_OBJECT | EFFECT_FILTER_OBJECT },
+	{ EffectId::PARTIAL_FILTER,		u8"部分フィルタ",			EFFECT_NON_OUTPUT_OBJECT },
+	{ EffectId::GROUP,				u8"グループ制御",			EFFECT_NON_OUTPUT_OBJECT | EFFECT_GROUP },
+	{ EffectId::GROUP_AUDIO,		u8"グループ制御(音声)",		EFFECT_NON_OUTPUT_OBJECT | EFFECT_GROUP | EFFECT_AUDIO },
+	{ EffectId::CAMERA,				u8"カメラ制御",				EFFECT_NON_OUTPUT_OBJECT },
+	{ EffectId::TIME_CONTROL,		u8"時間制御(オブジェクト)",	EFFECT_NON_OUTPUT_OBJECT },
+	{ EffectId::SCENE_CHANGE,		u8"シーンチェンジ",			EFFECT_NON_OUTPUT_OBJECT },
+};
+
+static constexpr size_t EFFECT_COUNT = sizeof(EFFECT_REGISTRY) / sizeof(EFFECT_REGISTRY[0]);
+
+
+// --- 完全ハッシュ (コンパイル時に衝突しない seed を探す) ---
+
+/// n 以上の最小の 2 の累乗
+constexpr size_t next_pow2(size_t n) {
+	size_t p = 1;
+	while (p < n) p <<= 1;
+	return p;
+}
+
+/// ハッシュテーブルのサイズ (2 の累乗)
+/// 登録数の 2 乗以上にすると、1つの seed で衝突しない確率が 1/2 程度になり、seed の探索が数回で終わる
+static constexpr size_t EFFECT_TABLE_SIZE = next_pow2(EFFECT_COUNT * EFFECT_COUNT < 64 ? 64 : EFFECT_COUNT * EFFECT_COUNT);
+static_assert(EFFECT_COUNT < 255, "EFFECT_TABLE は登録表のインデックス + 1 を uint8_t で保持するため、255 個未満にしてください");
+
+/// seed を探す回数の上限 (コンパイル時の評価の手数を抑える。EFFECT_TABLE_SIZE の大きさなら通常は数回で見つかる)
+static constexpr uint32_t EFFECT_SEED_SEARCH_LIMIT = 64;
+
+/// FNV-1a ハッシュ
+constexpr uint32_t effect_name_hash(std::string_view name, uint32_t seed) {
+	uint32_t h = 2166136261u ^ seed;
+	for (char c : name) {
+		h ^= (uint8_t)c;
+		h *= 16777619u;
+	}
+	return h;
+}
+
+/// 登録表のすべての名前が別のスロットに入る seed を探す
+/// 上限までに見つからなければ EFFECT_SEED_SEARCH_LIMIT を返す
+constexpr uint32_t find_effect_hash_seed() {
+	for (uint32_t seed = 0; seed < EFFECT_SEED_SEARCH_LIMIT; seed++) {
+		bool used[EFFECT_TABLE_SIZE] = {};
+		bool ok = true;
+		for (size_t i = 0; i < EFFECT_COUNT && ok; i++) {
+			size_t slot = effect_name_hash(EFFECT_REGISTRY[i].name, seed) & (EFFECT_TABLE_SIZE - 1);
+			ok = !used[slot];
+			used[slot] = true;
+		}
+		if (ok) return seed;
+	}
+	return EFFECT_SEED_SEARCH_LIMIT;
+}
+
+static constexpr uint32_t EFFECT_HASH_SEED = find_effect_hash_seed();
+static_assert(EFFECT_HASH_SEED < EFFECT_SEED_SEARCH_LIMIT, "衝突しない seed が見つかりません (EFFECT_TABLE_SIZE を大きくしてください)");
+
+/// スロット -> 登録表のインデックス + 1 (0 は空き)
+constexpr std::array<uint8_t, EFFECT_TABLE_SIZE> build_effect_table() {
+	std::array<uint8_t, EFFECT_TABLE_SIZE> table = {};
+	for (size_t i = 0; i < EFFECT_COUNT; i++) {
+		table[effect_name_hash(EFFECT_REGISTRY[i].name, EFFECT_HASH_SEED) & (EFFECT_TABLE_SIZE - 1)] = (uint8_t)(i + 1);
+	}
+	return table;
+}
+
+static constexpr std::array<uint8_t, EFFECT_TABLE_SIZE> EFFECT_TABLE = build_effect_table();
+
+
+/// エフェクト名から登録表の情報を引く (未登録なら nullptr)
+constexpr const EffectInfo* find_effect(std::string_view name) {
+	uint8_t entry = EFFECT_TABLE[effect_name_hash(name, EFFECT_HASH_SEED) & (EFFECT_TABLE_SIZE - 1)];
+	if (entry == 0 || EFFECT_REGISTRY[entry - 1].name != name) return nullptr;
+	return &EFFECT_REGISTRY[entry - 1];
+}
+
+/// エフェクト名を EffectId に変換する (未登録なら UNKNOWN)
+constexpr EffectId lookup_effect_id(std::string_view name) {
+	const EffectInfo* info = find_effect(name);
+	return info ? info->id : EffectId::UNKNOWN;
+}
+
+/// 登録表が EffectId の順に並んでいるか
+constexpr bool is_effect_registry_ordered() {
+	for (size_t i = 0; i < EFFECT_COUNT; i++) {
+		if ((size_t)EFFECT_REGISTRY[i].id != i + 1) return false;
+	}
+	return true;
+}
+static_assert(is_effect_registry_ordered(), "EFFECT_REGISTRY は EffectId の順に並べてください");
+
+/// EffectId の分類フラグを返す
+constexpr uint32_t effect_categories(EffectId id) {
+	return id == EffectId::UNKNOWN ? 0 : EFFECT_REGISTRY[(size_t)id - 1].categories;
+}
+
+/// EffectId が分類フラグのいずれかを持つか
+constexpr bool has_effect_category(EffectId id, uint32_t categories) {
+	return (effect_categories(id) & categories) != 0;
+}
+
+static_assert(lookup_effect_id(u8"フィルタオブジェクト") == EffectId::FILTER_OBJECT, "effect registry");
+static_assert(lookup_effect_id(u8"ぼかし") == EffectId::UNKNOWN, "effect registry");
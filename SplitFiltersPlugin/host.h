@@ -0,0 +1,66 @@
+#pragma once
+#include "host_api.h"
+#include "profiler.h"
+
+// --- EDIT_SECTION 呼び出しのラッパー ---
+// EDIT_SECTION の関数はすべてここを通して呼び出し、処理時間と回数を計測する
+
+inline OBJECT_HANDLE host_find_object(EDIT_SECTION* edit, int layer, int frame) {
+	ProfileSpan span(ProfileEvent::FIND_OBJECT);
+	g_host_calls.find_object++;
+	return edit->find_object(layer, frame);
+}
+
+inline OBJECT_LAYER_FRAME host_get_object_layer_frame(EDIT_SECTION* edit, OBJECT_HANDLE obj) {
+	ProfileSpan span(ProfileEvent::GET_LAYER_FRAME);
+	g_host_calls.get_layer_frame++;
+	return edit->get_object_layer_frame(obj);
+}
+
+inline LPCSTR host_get_object_alias(EDIT_SECTION* edit, OBJECT_HANDLE obj) {
+	ProfileSpan span(ProfileEvent::GET_ALIAS);
+	g_host_calls.get_alias++;
+	return edit->get_object_alias(obj);
+}
+
+inline OBJECT_HANDLE host_create_object_from_alias(EDIT_SECTION* edit, LPCSTR alias, int layer, int frame, int length) {
+	ProfileSpan span(ProfileEvent::CREATE_OBJECT);
+	g_host_calls.create_object++;
+	return edit->create_object_from_alias(alias, layer, frame, length);
+}
+
+inline void host_delete_object(EDIT_SECTION* edit, OBJECT_HANDLE obj) {
+	ProfileSpan span(ProfileEvent::DELETE_OBJECT);
+	g_host_calls.delete_object++;
+	edit->delete_object(obj);
+}
+
+inline OBJECT_HANDLE host_get_focus_object(EDIT_SECTION* edit) {
+	ProfileSpan span(ProfileEvent::GET_FOCUS_OBJECT);
+	g_host_calls.get_focus_object++;
+	return edit->get_focus_object();
+}
+
+inline void host_set_focus_object(EDIT_SECTION* edit, OBJECT_HANDLE obj) {
+	ProfileSpan span(ProfileEvent::SET_FOCUS_OBJECT);
+	g_host_calls.set_focus_object++;
+	edit->set_focus_object(obj);
+}
+
+inline OBJECT_HANDLE host_get_selected_object(EDIT_SECTION* edit, int index) {
+	ProfileSpan span(ProfileEvent::GET_SELECTED_OBJECT);
+	g_host_calls.get_selected_object++;
+	return edit->get_selected_object(index);
+}
+
+inline int host_get_selected_object_num(EDIT_SECTION* edit) {
+	ProfileSpan span(ProfileEvent::GET_SELECTED_OBJECT_NUM);
+	g_host_calls.get_selected_object_num++;
+	return edit->get_selected_object_num();
+}
+
+inline void host_set_object_name(EDIT_SECTION* edit, OBJECT_HANDLE obj, LPCWSTR name) {
+	ProfileSpan span(ProfileEvent::SET_OBJECT_NAME);
+	g_host_calls.set_object_name++;
+	edit->set_object_name(obj, name);
+}
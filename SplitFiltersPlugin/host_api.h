@@ -0,0 +1,32 @@
+#pragma once
+
+// --- AviUtl2 SDK のヘッダー ---
+// Windows では windows.h の後に SDK のヘッダーを読み込む
+// それ以外 (Linux でのテスト・記録の再生) では、SDK のヘッダーが参照する Win32 の型だけを定義して読み込む
+// (ウィンドウやタイマーなど Win32 の関数は util.h の関数を通して使う)
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <cstdint>
+
+typedef const char* LPCSTR;
+typedef const wchar_t* LPCWSTR;
+typedef void* HWND;
+typedef void* HINSTANCE;
+typedef int BOOL;
+typedef unsigned int UINT;
+typedef unsigned long DWORD;
+typedef uintptr_t UINT_PTR;
+
+#ifndef EXTERN_C
+#define EXTERN_C extern "C"
+#endif
+#ifndef __cdecl
+#define __cdecl
+#endif
+#endif
+
+#include "plugin2.h"
+#include "logger2.h"
+#include "config2.h"
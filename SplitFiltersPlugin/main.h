@@ -1,11 +1,4 @@
-#include "util.h"
-#include "logger2.h"
-#include "config2.h"
-
-// --- 外部変数宣言 ---
-extern EDIT_HANDLE* edit_handle;
-extern LOG_HANDLE* logger;
-
+#include "commands.h"
 
 // --- プラグイン情報定数 ---
 #define PLUGIN_NAME L"フィルタ分離"
@@ -16,4 +9,4 @@ extern LOG_HANDLE* logger;
 
 // --- DLLエクスポート関数宣言 ---
 EXTERN_C __declspec(dllexport) void InitializeLogger(LOG_HANDLE* handle);
-EXTERN_C __declspec(dllexport) void RegisterPlugin(HOST_APP_TABLE* host);
\ No newline at end of file
+EXTERN_C __declspec(dllexport) void RegisterPlugin(HOST_APP_TABLE* host);
@@ -0,0 +1,156 @@
+#include "profiler.h"
+#include <algorithm>
+#include <cstdio>
+#include <cwchar>
+#include <fstream>
+#include <mutex>
+#include <vector>
+
+std::atomic<bool> g_profile_enabled(false);
+HostCallCounts g_host_calls;
+
+/// ProfileEvent ごとの名前 (ログと JSON の両方で使う)
+static const char* PROFILE_EVENT_NAMES[] = {
+	"parse",
+	"build",
+	"layer_search",
+	"find_object",
+	"get_object_layer_frame",
+	"get_object_alias",
+	"create_object_from_alias",
+	"delete_object",
+	"get_focus_object",
+	"set_focus_object",
+	"get_selected_object",
+	"get_selected_object_num",
+	"set_object_name",
+};
+static_assert(sizeof(PROFILE_EVENT_NAMES) / sizeof(PROFILE_EVENT_NAMES[0]) == (size_t)ProfileEvent::COUNT, "PROFILE_EVENT_NAMES");
+
+/// ProfileCounter ごとの名前
+static const char* PROFILE_COUNTER_NAMES[] = {
+	"bytes_parsed",
+	"alias_cache_hits",
+	"alias_cache_misses",
+};
+static_assert(sizeof(PROFILE_COUNTER_NAMES) / sizeof(PROFILE_COUNTER_NAMES[0]) == (size_t)ProfileCounter::COUNT, "PROFILE_COUNTER_NAMES");
+
+/// 実行中のコマンドの計測結果
+static struct {
+	std::mutex mutex;
+	std::filesystem::path jsonl_path;
+	std::string command;
+	std::chrono::steady_clock::time_point start;
+	std::vector<int64_t> samples[(size_t)ProfileEvent::COUNT];
+	uint64_t counters[(size_t)ProfileCounter::COUNT] = {};
+} g_profile;
+
+
+void profile_configure(bool enabled, const std::filesystem::path& jsonl_path) {
+	std::lock_guard<std::mutex> lock(g_profile.mutex);
+	g_profile.jsonl_path = jsonl_path;
+	g_profile_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+
+void profile_record(ProfileEvent event, int64_t ns) {
+	std::lock_guard<std::mutex> lock(g_profile.mutex);
+	g_profile.samples[(size_t)event].push_back(ns);
+}
+
+
+void profile_count(ProfileCounter counter, uint64_t n) {
+	if (!profile_enabled()) return;
+	std::lock_guard<std::mutex> lock(g_profile.mutex);
+	g_profile.counters[(size_t)counter] += n;
+}
+
+
+void profile_begin_command(const char* command) {
+	if (!profile_enabled()) return;
+	std::lock_guard<std::mutex> lock(g_profile.mutex);
+	g_profile.command = command;
+	g_profile.start = std::chrono::steady_clock::now();
+	for (auto& s : g_profile.samples) s.clear();
+	for (auto& c : g_profile.counters) c = 0;
+}
+
+
+/// ASCII の文字列をワイド文字列にする
+static std::wstring ascii_to_wide(const std::string& s) {
+	return std::wstring(s.begin(), s.end());
+}
+
+
+/// 1種類の処理の集計
+struct EventSummary {
+	size_t count;
+	double total_us;
+	double p50_us;
+	double p99_us;
+};
+
+
+/// 記録した処理時間から集計を作る (samples は並べ替える)
+static EventSummary summarize(std::vector<int64_t>& samples) {
+	EventSummary sum = { samples.size(), 0.0, 0.0, 0.0 };
+	if (samples.empty()) return sum;
+
+	std::sort(samples.begin(), samples.end());
+	int64_t total = 0;
+	for (auto ns : samples) total += ns;
+	sum.total_us = total / 1000.0;
+	sum.p50_us = samples[(samples.size() - 1) * 50 / 100] / 1000.0;
+	sum.p99_us = samples[(samples.size() - 1) * 99 / 100] / 1000.0;
+	return sum;
+}
+
+
+std::wstring profile_end_command() {
+	if (!profile_enabled()) return {};
+	std::lock_guard<std::mutex> lock(g_profile.mutex);
+	if (g_profile.command.empty()) return {};
+
+	auto elapsed = std::chrono::steady_clock::now() - g_profile.start;
+	double command_us = std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count() / 1000.0;
+
+	wchar_t buf[256];
+	std::swprintf(buf, 256, L": %.1fus", command_us);
+	std::wstring text = L"[profile] " + ascii_to_wide(g_profile.command) + buf;
+
+	char json_buf[256];
+	std::snprintf(json_buf, sizeof(json_buf), "{\"command\":\"%s\",\"total_us\":%.1f", g_profile.command.c_str(), command_us);
+	std::string json = json_buf;
+
+	for (size_t i = 0; i < (size_t)ProfileCounter::COUNT; i++) {
+		unsigned long long value = g_profile.counters[i];
+		std::swprintf(buf, 256, L"=%llu", value);
+		text += L", " + ascii_to_wide(PROFILE_COUNTER_NAMES[i]) + buf;
+
+		std::snprintf(json_buf, sizeof(json_buf), ",\"%s\":%llu", PROFILE_COUNTER_NAMES[i], value);
+		json += json_buf;
+	}
+	json += ",\"events\":{";
+
+	bool first = true;
+	for (size_t i = 0; i < (size_t)ProfileEvent::COUNT; i++) {
+		if (g_profile.samples[i].empty()) continue;
+		EventSummary sum = summarize(g_profile.samples[i]);
+
+		std::swprintf(buf, 256, L" n=%zu total=%.1fus p50=%.1fus p99=%.1fus", sum.count, sum.total_us, sum.p50_us, sum.p99_us);
+		text += L"\n  " + ascii_to_wide(PROFILE_EVENT_NAMES[i]) + buf;
+
+		std::snprintf(json_buf, sizeof(json_buf), "%s\"%s\":{\"count\":%zu,\"total_us\":%.1f,\"p50_us\":%.1f,\"p99_us\":%.1f}", first ? "" : ",", PROFILE_EVENT_NAMES[i], sum.count, sum.total_us, sum.p50_us, sum.p99_us);
+		json += json_buf;
+		first = false;
+	}
+	json += "}}\n";
+
+	if (!g_profile.jsonl_path.empty()) {
+		std::ofstream out(g_profile.jsonl_path, std::ios::app | std::ios::binary);
+		if (out) out << json;
+	}
+
+	g_profile.command.clear();
+	return text;
+}
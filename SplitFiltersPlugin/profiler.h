@@ -0,0 +1,108 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+
+// --- 処理時間の計測 ---
+// 無効時は ProfileSpan がフラグを1回読むだけで、時刻の取得や記録は行わない
+
+/// 計測する処理の種類
+enum class ProfileEvent : uint8_t {
+	PARSE,				// エイリアスの解析
+	BUILD,				// エイリアスの作成
+	LAYER_SEARCH,		// 空きレイヤー・上のオブジェクトの検索
+	FIND_OBJECT,		// EDIT_SECTION::find_object
+	GET_LAYER_FRAME,	// EDIT_SECTION::get_object_layer_frame
+	GET_ALIAS,			// EDIT_SECTION::get_object_alias
+	CREATE_OBJECT,		// EDIT_SECTION::create_object_from_alias
+	DELETE_OBJECT,		// EDIT_SECTION::delete_object
+	GET_FOCUS_OBJECT,	// EDIT_SECTION::get_focus_object
+	SET_FOCUS_OBJECT,	// EDIT_SECTION::set_focus_object
+	GET_SELECTED_OBJECT,		// EDIT_SECTION::get_selected_object
+	GET_SELECTED_OBJECT_NUM,	// EDIT_SECTION::get_selected_object_num
+	SET_OBJECT_NAME,	// EDIT_SECTION::set_object_name
+	COUNT
+};
+
+/// 回数・量を数える項目
+enum class ProfileCounter : uint8_t {
+	BYTES_PARSED,		// 解析したエイリアスのバイト数
+	ALIAS_CACHE_HIT,	// 解析済みエイリアスのキャッシュにあった回数
+	ALIAS_CACHE_MISS,	// キャッシュになく解析した回数
+	COUNT
+};
+
+/// 計測が有効か
+extern std::atomic<bool> g_profile_enabled;
+
+inline bool profile_enabled() {
+	return g_profile_enabled.load(std::memory_order_relaxed);
+}
+
+/// 計測の設定を行う
+/// @param enabled: 計測を有効にするか
+/// @param jsonl_path: コマンドごとの集計を追記する JSON Lines ファイル (空なら書き出さない)
+void profile_configure(bool enabled, const std::filesystem::path& jsonl_path);
+
+/// 処理時間を記録する (複数スレッドから呼び出してよい)
+void profile_record(ProfileEvent event, int64_t ns);
+/// 回数・量を加算する (複数スレッドから呼び出してよい)
+void profile_count(ProfileCounter counter, uint64_t n = 1);
+
+/// コマンドの計測を開始する
+/// @param command: コマンド名 (JSON にそのまま書き出すため英数字のみ)
+void profile_begin_command(const char* command);
+/// コマンドの計測を終了し、集計を JSON Lines ファイルに書き出す
+/// @return ログ出力用の集計 (無効時は空)
+std::wstring profile_end_command();
+
+
+/// スコープの処理時間を計測する
+class ProfileSpan {
+public:
+	explicit ProfileSpan(ProfileEvent event) : event(event), active(profile_enabled()) {
+		if (active) start = std::chrono::steady_clock::now();
+	}
+	~ProfileSpan() {
+		if (active) {
+			auto elapsed = std::chrono::steady_clock::now() - start;
+			profile_record(event, std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+		}
+	}
+	ProfileSpan(const ProfileSpan&) = delete;
+	ProfileSpan& operator=(const ProfileSpan&) = delete;
+
+private:
+	ProfileEvent event;
+	bool active;
+	std::chrono::steady_clock::time_point start;
+};
+
+
+// --- ホスト呼び出しの回数 ---
+// 計測の有効・無効にかかわらず数え、コマンドごとの予算と比べる
+
+/// コマンド内のホスト呼び出しの回数
+struct HostCallCounts {
+	uint32_t find_object = 0;
+	uint32_t get_layer_frame = 0;
+	uint32_t get_alias = 0;
+	uint32_t create_object = 0;
+	uint32_t delete_object = 0;
+	uint32_t get_focus_object = 0;
+	uint32_t set_focus_object = 0;
+	uint32_t get_selected_object = 0;
+	uint32_t get_selected_object_num = 0;
+	uint32_t set_object_name = 0;
+
+	uint32_t total() const {
+		return find_object + get_layer_frame + get_alias + create_object + delete_object
+			+ get_focus_object + set_focus_object + get_selected_object + get_selected_object_num + set_object_name;
+	}
+};
+
+/// 実行中のコマンドのホスト呼び出しの回数
+/// EDIT_SECTION は並列処理中には呼び出さないため、排他制御はしない
+extern HostCallCounts g_host_calls;
@@ -0,0 +1,118 @@
+#include "thread_pool.h"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <mutex>
+#include <thread>
+
+/// 1回の parallel_for の処理
+struct ParallelJob {
+	const std::function<void(size_t)>* fn;
+	size_t count;
+	std::atomic<size_t> next{ 0 };
+	unsigned int slots = 0;		// まだ参加できるワーカーの数
+	unsigned int active = 0;	// 参加して処理中のワーカーの数
+	std::exception_ptr error;	// 最初に投げられた例外
+};
+
+/// parallel_for の中 (ワーカースレッド、または処理中の呼び出し元) か
+static thread_local bool t_in_parallel_for = false;
+
+/// 使い回すワーカースレッド
+/// DLL の解放時にスレッドの終了を待つとローダーロックでデッドロックするため、作成したら破棄しない
+class ThreadPool {
+public:
+	void run(ParallelJob& job, unsigned int workers) {
+		std::lock_guard<std::mutex> submit(submit_mutex);
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			while (threads < workers) {
+				std::thread(&ThreadPool::worker_loop, this).detach();
+				threads++;
+			}
+			job.slots = workers;
+			current = &job;
+			generation++;
+		}
+		work_cv.notify_all();
+
+		run_items(job);
+
+		std::unique_lock<std::mutex> lock(mutex);
+		job.slots = 0;	// 遅れて起きたワーカーは参加させない
+		done_cv.wait(lock, [&] { return job.active == 0; });
+		current = nullptr;
+	}
+
+	/// job の処理を取り出して実行する (例外は job.error に残し、残りの処理を打ち切る)
+	void run_items(ParallelJob& job) {
+		try {
+			for (size_t i; (i = job.next.fetch_add(1)) < job.count; ) (*job.fn)(i);
+		}
+		catch (...) {
+			std::lock_guard<std::mutex> lock(mutex);
+			if (!job.error) job.error = std::current_exception();
+			job.next.store(job.count);
+		}
+	}
+
+private:
+	void worker_loop() {
+		t_in_parallel_for = true;
+		uint64_t seen = 0;
+		std::unique_lock<std::mutex> lock(mutex);
+		for (;;) {
+			work_cv.wait(lock, [&] { return current && generation != seen && current->slots > 0; });
+			seen = generation;
+			ParallelJob& job = *current;
+			job.slots--;
+			job.active++;
+			lock.unlock();
+
+			run_items(job);
+
+			lock.lock();
+			if (--job.active == 0) done_cv.notify_all();
+		}
+	}
+
+	std::mutex submit_mutex;	// 複数のスレッドからの parallel_for を1つずつ実行する
+	std::mutex mutex;
+	std::condition_variable work_cv;
+	std::condition_variable done_cv;
+	ParallelJob* current = nullptr;
+	uint64_t generation = 0;
+	unsigned int threads = 0;
+};
+
+
+static ThreadPool& thread_pool() {
+	static ThreadPool* pool = new ThreadPool();
+	return *pool;
+}
+
+
+void parallel_for(size_t count, const std::function<void(size_t)>& fn, unsigned int max_threads) {
+	size_t thread_num = max_threads ? max_threads : std::max(1u, std::thread::hardware_concurrency());
+	thread_num = std::min(thread_num, (count + PARALLEL_MIN_ITEMS - 1) / PARALLEL_MIN_ITEMS);
+
+	if (thread_num <= 1 || t_in_parallel_for) {
+		for (size_t i = 0; i < count; i++) fn(i);
+		return;
+	}
+
+	ParallelJob job;
+	job.fn = &fn;
+	job.count = count;
+	t_in_parallel_for = true;
+	thread_pool().run(job, (unsigned int)thread_num - 1);
+	t_in_parallel_for = false;
+	if (job.error) std::rethrow_exception(job.error);
+}
+
+
+bool in_parallel_for() {
+	return t_in_parallel_for;
+}
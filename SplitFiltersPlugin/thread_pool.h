@@ -0,0 +1,23 @@
+#pragma once
+#include <cstddef>
+#include <functional>
+
+// --- 並列処理 ---
+// ワーカースレッドは最初の並列処理で作成し、プラグインの終了まで使い回す (呼び出しごとに作成・終了しない)
+// ホストに依存しないため、プラグイン外でも単体でビルドできる
+
+/// 並列処理で1スレッドに割り当てる最小の処理数 (これより少ない場合はスレッドを増やさない)
+const size_t PARALLEL_MIN_ITEMS = 8;
+
+/// fn(0) ～ fn(count - 1) をスレッドプールで並列に実行する
+/// 各 fn は結果を自分のインデックスにだけ書き込むこと（実行順序によらず結果が同じになる）
+/// fn が例外を投げた場合は残りの処理を打ち切り、すべてのスレッドが抜けてから呼び出し元のスレッドで最初の例外を投げ直す
+/// fn の中から parallel_for を呼び出した場合は、そのスレッドで順に実行する
+/// @param count: 処理数
+/// @param fn: 処理関数 (ホストの関数を呼び出さないこと)
+/// @param max_threads: 最大スレッド数 (呼び出し元のスレッドを含む。0 ならハードウェアのスレッド数)
+void parallel_for(size_t count, const std::function<void(size_t)>& fn, unsigned int max_threads = 0);
+
+/// 呼び出し元のスレッドが parallel_for の中 (ワーカースレッド、または処理中の呼び出し元) か
+/// parallel_for の外でだけ更新する共有データの確認に使う
+bool in_parallel_for();
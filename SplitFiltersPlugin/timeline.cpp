@@ -0,0 +1,305 @@
+#include "timeline.h"
+#include "host.h"
+#include <algorithm>
+#include <climits>
+#include <iterator>
+
+LayerOccupancy::LayerOccupancy(EDIT_SECTION* edit)
+	: edit(edit), layer_max(edit->info ? edit->info->layer_max : SAFE_LAYER_LIMIT), layers(command_resource()) {
+}
+
+
+/// 区間の集合が [start_frame, end_frame] を含むか
+static bool contains(const std::pmr::map<int, int>& intervals, int start_frame, int end_frame) {
+	auto it = intervals.upper_bound(start_frame);
+	if (it == intervals.begin()) return false;
+	--it;
+	return it->second >= end_frame;
+}
+
+
+/// 区間の集合に [start_frame, end_frame] を加え、隣接・重複する区間をまとめる
+static void merge_into(std::pmr::map<int, int>& intervals, int start_frame, int end_frame) {
+	auto it = intervals.upper_bound(start_frame);
+	if (it != intervals.begin()) {
+		auto prev = std::prev(it);
+		if (prev->second >= start_frame - 1) {
+			start_frame = prev->first;
+			end_frame = std::max(end_frame, prev->second);
+			it = prev;
+		}
+	}
+	while (it != intervals.end() && it->first - 1 <= end_frame) {	// end_frame が INT_MAX でも溢れないようにする
+		end_frame = std::max(end_frame, it->second);
+		it = intervals.erase(it);
+	}
+	intervals[start_frame] = end_frame;
+}
+
+
+/// レイヤーの [start_frame, end_frame] を確認済みにする（未確認であればホストに問い合わせる）
+/// @param layer 対象のレイヤー
+LayerOccupancy::Layer& LayerOccupancy::load_range(int layer, int start_frame, int end_frame) {
+	Layer& l = layers[layer];
+
+	// オブジェクトが存在する最大レイヤーより下は空
+	if (layer > layer_max) {
+		if (l.known.empty()) l.known[0] = INT_MAX;
+		return l;
+	}
+
+	// start_frame 以降のオブジェクトを順にたどり、end_frame まで確認する
+	int frame = start_frame;
+	while (frame <= end_frame && !contains(l.known, frame, end_frame)) {
+		// 確認済みの範囲は飛ばす
+		auto it = l.known.upper_bound(frame);
+		if (it != l.known.begin() && std::prev(it)->second >= frame) {
+			frame = std::prev(it)->second + 1;
+			continue;
+		}
+
+		auto obj = host_find_object(edit, layer, frame);
+		if (!obj) {
+			merge_into(l.known, frame, INT_MAX);
+			break;
+		}
+		auto lf = host_get_object_layer_frame(edit, obj);
+		if (lf.end < frame) break;
+
+		l.objects[lf.start] = { lf.end, obj };
+		merge_into(l.known, std::min(frame, lf.start), lf.end);
+		frame = lf.end + 1;
+	}
+	return l;
+}
+
+
+/// 指定レイヤーの区間に被るオブジェクトを返す
+/// @param layer 対象のレイヤー
+/// @param start_frame 開始フレーム
+/// @param end_frame 終了フレーム
+/// @param lf [out] 見つかったオブジェクトのレイヤー・フレーム
+/// @return 被るオブジェクト (なければ nullptr)
+OBJECT_HANDLE LayerOccupancy::find_overlap(int layer, int start_frame, int end_frame, OBJECT_LAYER_FRAME* lf) {
+	const auto& objects = load_range(layer, start_frame, end_frame).objects;
+
+	// 終了フレーム以前に始まる最後の区間とだけ比較すればよい
+	auto it = objects.upper_bound(end_frame);
+	if (it == objects.begin()) return nullptr;
+	--it;
+
+	// 重複判定: 交差しない条件: (lf.end < start_frame) || (lf.start > end_frame)
+	if (it->second.end < start_frame) return nullptr;
+
+	if (lf) *lf = { layer, it->first, it->second.end };
+	return it->second.obj;
+}
+
+
+/// 指定レイヤーの区間が空いているかを判定する
+/// @param layer 対象のレイヤー
+/// @param start_frame 開始フレーム
+/// @param end_frame 終了フレーム
+/// @return 被るオブジェクト (予約済みの区間を含む) がなければ true
+bool LayerOccupancy::is_free(int layer, int start_frame, int end_frame) {
+	const auto& objects = load_range(layer, start_frame, end_frame).objects;
+
+	// 予約済みの区間はオブジェクトが nullptr なので、find_overlap ではなく区間で判定する
+	auto it = objects.upper_bound(end_frame);
+	return it == objects.begin() || std::prev(it)->second.end < start_frame;
+}
+
+
+/// 上のレイヤーから、指定範囲に被る最も近いオブジェクトを探す
+/// 選択オブジェクトより前から始まっているオブジェクトも対象にする
+/// @param layer 基準のレイヤー (このレイヤーより上を探す)
+/// @param start_frame 開始フレーム
+/// @param end_frame 終了フレーム
+/// @param lf [out] 見つかったオブジェクトのレイヤー・フレーム
+/// @return 見つかったオブジェクト (なければ nullptr)
+OBJECT_HANDLE LayerOccupancy::find_object_above(int layer, int start_frame, int end_frame, OBJECT_LAYER_FRAME* lf) {
+	ProfileSpan span(ProfileEvent::LAYER_SEARCH);
+	for (int above = layer - 1; above >= 0 && layer - above < SAFE_LAYER_LIMIT; --above) {
+		if (auto obj = find_overlap(above, start_frame, end_frame, lf)) {
+			return obj;
+		}
+	}
+	return nullptr;
+}
+
+
+/// 指定範囲に被らない最初のレイヤーを返す
+/// @param start_layer 探索を開始するレイヤー（通常は元レイヤー+1）
+/// @param start_frame 探索対象の開始フレーム
+/// @param end_frame 探索対象の終了フレーム
+int LayerOccupancy::find_available_layer(int start_layer, int start_frame, int end_frame) {
+	ProfileSpan span(ProfileEvent::LAYER_SEARCH);
+	for (int layer = start_layer; layer < SAFE_LAYER_LIMIT; ++layer) {
+		if (is_free(layer, start_frame, end_frame)) {
+			return layer;
+		}
+	}
+	return -1;
+}
+
+
+/// 指定レイヤーの区間に掛かるオブジェクトを集める
+/// 未確認の範囲は、ホストに問い合わせてレイヤーを一度だけ走査する
+/// @param layer 対象のレイヤー
+/// @param start_frame 開始フレーム
+/// @param end_frame 終了フレーム
+/// @param out [out] 見つかったオブジェクトを追加する
+void LayerOccupancy::collect_objects(int layer, int start_frame, int end_frame, std::vector<TargetObject>& out) {
+	const auto& objects = load_range(layer, start_frame, end_frame).objects;
+
+	// start_frame より前から始まって掛かっているオブジェクトも含める
+	auto it = objects.upper_bound(start_frame);
+	if (it != objects.begin() && std::prev(it)->second.end >= start_frame) --it;
+	for (; it != objects.end() && it->first <= end_frame; ++it) {
+		if (!it->second.obj) continue;	// 予約済みの区間
+		TargetObject target;
+		target.obj = it->second.obj;
+		target.lf = { layer, it->first, it->second.end };
+		out.push_back(std::move(target));
+	}
+}
+
+
+void LayerOccupancy::add(const OBJECT_LAYER_FRAME& lf, OBJECT_HANDLE obj) {
+	Layer& l = layers[lf.layer];
+	l.objects[lf.start] = { lf.end, obj };
+	merge_into(l.known, lf.start, lf.end);
+}
+
+
+void LayerOccupancy::remove(const OBJECT_LAYER_FRAME& lf) {
+	Layer& l = layers[lf.layer];
+	l.objects.erase(lf.start);
+	merge_into(l.known, lf.start, lf.end);
+}
+
+
+/// オブジェクトのレイヤー・フレームとエイリアスを取得する
+/// @param obj 対象のオブジェクト
+TargetObject snapshot_object(EDIT_SECTION* edit, OBJECT_HANDLE obj) {
+	TargetObject target;
+	target.obj = obj;
+	target.lf = host_get_object_layer_frame(edit, obj);
+	const char* alias = host_get_object_alias(edit, obj);
+	target.alias = std::make_shared<const std::string>(alias ? alias : "");
+	return target;
+}
+
+
+/// 選択中オブジェクトの位置をまとめて取得する (エイリアスは取得しない)
+/// @return 選択中オブジェクト (選択がなければフォーカス中のオブジェクト、それもなければ空)
+static std::vector<TargetObject> locate_selection(EDIT_SECTION* edit) {
+	std::vector<TargetObject> targets;
+
+	int sel_num = host_get_selected_object_num(edit);
+	targets.reserve(sel_num > 0 ? sel_num : 1);
+	for (int i = 0; i < sel_num; i++) {
+		if (auto obj = host_get_selected_object(edit, i)) {
+			targets.push_back({ obj, host_get_object_layer_frame(edit, obj), nullptr });
+		}
+	}
+
+	// 選択オブジェクトがなければ、フォーカス中のオブジェクトを使う
+	if (targets.empty()) {
+		if (auto obj = host_get_focus_object(edit)) {
+			targets.push_back({ obj, host_get_object_layer_frame(edit, obj), nullptr });
+		}
+	}
+	return targets;
+}
+
+
+/// 対象オブジェクトを処理する順に並べ替える (下のレイヤーから、開始フレーム順)
+/// 分離したフィルタ効果は元オブジェクトの下に置くため、下のオブジェクトから先に配置すれば、
+/// 上のオブジェクトの配置が下のオブジェクトのすぐ下の空きを奪うことがない
+/// また、同じレイヤーの使用区間をフレーム順に確認するため、ホストへの問い合わせが連続した範囲で済む
+static void sort_for_placement(std::vector<TargetObject>& targets) {
+	std::sort(targets.begin(), targets.end(), [](const TargetObject& a, const TargetObject& b) {
+		if (a.lf.layer != b.lf.layer) return a.lf.layer > b.lf.layer;
+		return a.lf.start < b.lf.start;
+	});
+}
+
+
+/// 対象範囲のオブジェクトの位置をまとめて取得する (エイリアスは取得しない)
+/// 選択中オブジェクトは、取得したレイヤー・フレームを occupancy に加えてホストに問い合わせ直さないようにする
+/// それ以外の範囲は、occupancy でレイヤーを一度ずつ走査して集める
+/// (どちらもそのままコマンド内の配置・検索に使われる)
+/// @param occupancy コマンドで使うレイヤーの使用区間
+/// @param scope 対象範囲
+/// @return 対象オブジェクト (順不同)
+std::vector<TargetObject> locate_targets(EDIT_SECTION* edit, LayerOccupancy& occupancy, TargetScope scope) {
+	if (scope == TargetScope::SELECTION || !edit->info) {
+		auto targets = locate_selection(edit);
+		for (const auto& target : targets) occupancy.add(target.lf, target.obj);
+		return targets;
+	}
+
+	const EDIT_INFO& info = *edit->info;
+	int first_layer = 0;
+	int last_layer = occupancy.max_layer();
+	int start_frame = 0;
+	int end_frame = INT_MAX;
+	switch (scope) {
+	case TargetScope::LAYER:
+		// フォーカス中のオブジェクトのレイヤー (なければ選択中のレイヤー)
+		if (auto obj = host_get_focus_object(edit)) {
+			first_layer = host_get_object_layer_frame(edit, obj).layer;
+		}
+		else {
+			first_layer = info.layer;
+		}
+		last_layer = first_layer;
+		break;
+	case TargetScope::FRAME_RANGE:
+		// 選択範囲 (なければ現在のフレーム)
+		if (info.select_range_start >= 0 && info.select_range_end >= info.select_range_start) {
+			start_frame = info.select_range_start;
+			end_frame = info.select_range_end;
+		}
+		else {
+			start_frame = end_frame = info.frame;
+		}
+		break;
+	default:
+		break;
+	}
+
+	std::vector<TargetObject> targets;
+	for (int layer = first_layer; layer <= last_layer; layer++) {
+		occupancy.collect_objects(layer, start_frame, end_frame, targets);
+	}
+	return targets;
+}
+
+
+/// 位置を取得した対象オブジェクトのエイリアスを取得し、処理する順に並べ替える
+void fetch_target_aliases(EDIT_SECTION* edit, std::vector<TargetObject>& targets) {
+	for (auto& target : targets) {
+		const char* alias = host_get_object_alias(edit, target.obj);
+		target.alias = std::make_shared<const std::string>(alias ? alias : "");
+	}
+	sort_for_placement(targets);
+}
+
+
+/// 以前のコマンドで位置を取得したオブジェクトが、同じ位置にあるか確かめ直す
+/// 削除・移動されたオブジェクトは除き、残りは最新のレイヤー・フレームを occupancy に加える
+/// @param targets [in,out] 対象オブジェクト (alias は取得しない)
+/// @return 除いたオブジェクトの数
+size_t relocate_targets(EDIT_SECTION* edit, LayerOccupancy& occupancy, std::vector<TargetObject>& targets) {
+	size_t count = targets.size();
+	targets.erase(std::remove_if(targets.begin(), targets.end(), [&](TargetObject& target) {
+		// 同じ位置に同じオブジェクトがなければ、ハンドルには触れずに除く
+		if (host_find_object(edit, target.lf.layer, target.lf.start) != target.obj) return true;
+		target.lf = host_get_object_layer_frame(edit, target.obj);
+		occupancy.add(target.lf, target.obj);
+		return false;
+	}), targets.end());
+	return count - targets.size();
+}
@@ -0,0 +1,80 @@
+#pragma once
+#include "util.h"
+#include "arena.h"
+#include <map>
+#include <unordered_map>
+
+/// コマンド開始時点の対象オブジェクト
+struct TargetObject {
+	OBJECT_HANDLE obj;
+	OBJECT_LAYER_FRAME lf;
+	std::shared_ptr<const std::string> alias;	// ホストのエイリアスのコピー
+};
+
+/// コマンドの対象範囲
+enum class TargetScope {
+	SELECTION,		// 選択中オブジェクト (なければフォーカス中のオブジェクト)
+	LAYER,			// フォーカス中のレイヤーのすべてのオブジェクト
+	FRAME_RANGE,	// 選択範囲 (なければ現在のフレーム) に掛かるすべてのオブジェクト
+	SCENE			// シーンのすべてのオブジェクト
+};
+
+
+/// タイムラインのレイヤーごとの使用区間
+/// コマンド実行中だけ使用する。ホストへの問い合わせは未確認のフレーム範囲に対してのみ行い、
+/// 確認済みの範囲はコマンド内で行ったオブジェクトの作成・削除を反映して使い回す
+/// 区間はコマンドの作業領域 (command_resource) から確保する
+class LayerOccupancy {
+public:
+	explicit LayerOccupancy(EDIT_SECTION* edit);
+
+	/// [start_frame, end_frame] に被らない最初のレイヤーを返す (見つからなければ -1)
+	int find_available_layer(int start_layer, int start_frame, int end_frame);
+	/// 指定レイヤーの [start_frame, end_frame] が空いているか
+	bool is_free(int layer, int start_frame, int end_frame);
+	/// 指定レイヤーの [start_frame, end_frame] に被るオブジェクトを返す (なければ nullptr)
+	OBJECT_HANDLE find_overlap(int layer, int start_frame, int end_frame, OBJECT_LAYER_FRAME* lf = nullptr);
+	/// layer より上で [start_frame, end_frame] に被る最も近いオブジェクトを返す (なければ nullptr)
+	OBJECT_HANDLE find_object_above(int layer, int start_frame, int end_frame, OBJECT_LAYER_FRAME* lf = nullptr);
+
+	/// 指定レイヤーの [start_frame, end_frame] に掛かるオブジェクトを開始フレーム順に out へ追加する (alias は取得しない)
+	void collect_objects(int layer, int start_frame, int end_frame, std::vector<TargetObject>& out);
+	/// オブジェクトが存在する最大レイヤー
+	int max_layer() const { return layer_max; }
+
+	/// オブジェクトの作成を反映する
+	void add(const OBJECT_LAYER_FRAME& lf, OBJECT_HANDLE obj);
+	/// オブジェクトの削除を反映する
+	void remove(const OBJECT_LAYER_FRAME& lf);
+
+private:
+	/// フレーム区間の集合 (開始フレーム -> 終了フレーム)
+	typedef std::pmr::map<int, int> Intervals;
+
+	/// レイヤー上のオブジェクト
+	struct Entry {
+		int end;
+		OBJECT_HANDLE obj;
+	};
+
+	struct Layer {
+		// layers と同じ作業領域から確保する
+		typedef std::pmr::polymorphic_allocator<std::byte> allocator_type;
+		explicit Layer(const allocator_type& alloc) : objects(alloc), known(alloc) {}
+		Layer(Layer&& other, const allocator_type& alloc) : objects(std::move(other.objects), alloc), known(std::move(other.known), alloc) {}
+
+		std::pmr::map<int, Entry> objects;	// 開始フレーム -> オブジェクト
+		Intervals known;					// ホストに問い合わせ済みの範囲
+	};
+	Layer& load_range(int layer, int start_frame, int end_frame);
+
+	EDIT_SECTION* edit;
+	int layer_max;
+	std::pmr::unordered_map<int, Layer> layers;
+};
+
+
+TargetObject snapshot_object(EDIT_SECTION* edit, OBJECT_HANDLE obj);
+std::vector<TargetObject> locate_targets(EDIT_SECTION* edit, LayerOccupancy& occupancy, TargetScope scope);
+void fetch_target_aliases(EDIT_SECTION* edit, std::vector<TargetObject>& targets);
+size_t relocate_targets(EDIT_SECTION* edit, LayerOccupancy& occupancy, std::vector<TargetObject>& targets);
@@ -0,0 +1,490 @@
+#include "trace.h"
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <unordered_map>
+
+/// 記録ファイルの先頭 (形式を変えたら番号を上げる)
+static const char TRACE_MAGIC[] = "SFTRACE1";
+static const size_t TRACE_MAGIC_SIZE = sizeof(TRACE_MAGIC) - 1;
+
+
+// --- 符号化 ---
+// 数値は 7bit ずつの可変長 (符号付きはジグザグ符号化)、文字列は長さ + バイト列で書く
+
+static void put_uint(std::string& out, uint64_t v) {
+	while (v >= 0x80) {
+		out += (char)(v | 0x80);
+		v >>= 7;
+	}
+	out += (char)v;
+}
+
+static void put_int(std::string& out, int64_t v) {
+	put_uint(out, ((uint64_t)v << 1) ^ (uint64_t)(v >> 63));
+}
+
+static void put_bytes(std::string& out, std::string_view s) {
+	put_uint(out, s.size());
+	out.append(s);
+}
+
+
+/// 記録ファイルの読み込み (壊れた内容を読んだら ok が false になり、以降は 0 を返す)
+struct TraceReader {
+	const char* p;
+	const char* end;
+	bool ok = true;
+
+	uint64_t get_uint() {
+		uint64_t v = 0;
+		for (int shift = 0; shift < 64; shift += 7) {
+			if (p == end) break;
+			uint8_t c = (uint8_t)*p++;
+			v |= (uint64_t)(c & 0x7f) << shift;
+			if (!(c & 0x80)) return v;
+		}
+		ok = false;
+		return 0;
+	}
+
+	int64_t get_int() {
+		uint64_t v = get_uint();
+		return (int64_t)(v >> 1) ^ -(int64_t)(v & 1);
+	}
+
+	std::string_view get_bytes() {
+		uint64_t size = get_uint();
+		if (!ok || size > (uint64_t)(end - p)) {
+			ok = false;
+			return {};
+		}
+		std::string_view s(p, (size_t)size);
+		p += size;
+		return s;
+	}
+};
+
+
+/// FNV-1a ハッシュ
+static uint64_t trace_hash(const void* data, size_t size) {
+	uint64_t h = 14695981039346656037ull;
+	auto bytes = (const uint8_t*)data;
+	for (size_t i = 0; i < size; i++) {
+		h = (h ^ bytes[i]) * 1099511628211ull;
+	}
+	return h;
+}
+
+static uint64_t trace_hash(LPCSTR s) {
+	return s ? trace_hash(s, std::strlen(s)) : 0;
+}
+
+static uint64_t trace_hash(LPCWSTR s) {
+	return s ? trace_hash(s, std::wcslen(s) * sizeof(wchar_t)) : 0;
+}
+
+
+// --- 記録 ---
+// コマンドはホストのスレッドから1つずつ呼び出され、EDIT_SECTION は並列処理中には呼び出さないため、排他制御はしない
+
+/// 記録中のコマンド
+static struct {
+	std::filesystem::path path;
+	bool active = false;
+	EDIT_SECTION host = {};			// ホストの EDIT_SECTION (記録した呼び出しの転送先)
+	EDIT_SECTION section = {};		// コマンドに渡す、呼び出しを記録する EDIT_SECTION
+	std::string header;
+	std::string body;
+	std::unordered_map<OBJECT_HANDLE, uint32_t> objects;	// オブジェクト → ID
+	std::unordered_map<std::string, uint32_t> texts;		// 記録済みのエイリアス → 番号
+} g_trace;
+
+
+/// オブジェクトの ID を返す (初めてのオブジェクトには新しい ID を振る)
+static uint32_t object_id(OBJECT_HANDLE obj) {
+	if (!obj) return 0;
+	auto result = g_trace.objects.emplace(obj, (uint32_t)g_trace.objects.size() + 1);
+	return result.first->second;
+}
+
+static void put_op(TraceOp op) {
+	g_trace.body += (char)op;
+}
+
+static void put_object(OBJECT_HANDLE obj) {
+	put_uint(g_trace.body, object_id(obj));
+}
+
+
+static OBJECT_HANDLE trace_find_object(int layer, int frame) {
+	auto obj = g_trace.host.find_object(layer, frame);
+	put_op(TraceOp::FIND_OBJECT);
+	put_int(g_trace.body, layer);
+	put_int(g_trace.body, frame);
+	put_object(obj);
+	return obj;
+}
+
+static OBJECT_LAYER_FRAME trace_get_object_layer_frame(OBJECT_HANDLE obj) {
+	auto lf = g_trace.host.get_object_layer_frame(obj);
+	put_op(TraceOp::GET_LAYER_FRAME);
+	put_object(obj);
+	put_int(g_trace.body, lf.layer);
+	put_int(g_trace.body, lf.start);
+	put_int(g_trace.body, lf.end);
+	return lf;
+}
+
+static LPCSTR trace_get_object_alias(OBJECT_HANDLE obj) {
+	auto alias = g_trace.host.get_object_alias(obj);
+	put_op(TraceOp::GET_ALIAS);
+	put_object(obj);
+	if (!alias) {
+		put_uint(g_trace.body, 0);
+		return alias;
+	}
+
+	// 同じ内容のエイリアスは番号だけを書く
+	auto result = g_trace.texts.emplace(alias, (uint32_t)g_trace.texts.size());
+	put_uint(g_trace.body, result.first->second + 1);
+	if (result.second) put_bytes(g_trace.body, result.first->first);
+	return alias;
+}
+
+static OBJECT_HANDLE trace_create_object_from_alias(LPCSTR alias, int layer, int frame, int length) {
+	auto obj = g_trace.host.create_object_from_alias(alias, layer, frame, length);
+	put_op(TraceOp::CREATE_OBJECT);
+	put_uint(g_trace.body, trace_hash(alias));
+	put_int(g_trace.body, layer);
+	put_int(g_trace.body, frame);
+	put_int(g_trace.body, length);
+	put_object(obj);
+	return obj;
+}
+
+static void trace_delete_object(OBJECT_HANDLE obj) {
+	put_op(TraceOp::DELETE_OBJECT);
+	put_object(obj);
+	g_trace.host.delete_object(obj);
+}
+
+static OBJECT_HANDLE trace_get_focus_object() {
+	auto obj = g_trace.host.get_focus_object();
+	put_op(TraceOp::GET_FOCUS_OBJECT);
+	put_object(obj);
+	return obj;
+}
+
+static void trace_set_focus_object(OBJECT_HANDLE obj) {
+	put_op(TraceOp::SET_FOCUS_OBJECT);
+	put_object(obj);
+	g_trace.host.set_focus_object(obj);
+}
+
+static OBJECT_HANDLE trace_get_selected_object(int index) {
+	auto obj = g_trace.host.get_selected_object(index);
+	put_op(TraceOp::GET_SELECTED_OBJECT);
+	put_int(g_trace.body, index);
+	put_object(obj);
+	return obj;
+}
+
+static int trace_get_selected_object_num() {
+	int num = g_trace.host.get_selected_object_num();
+	put_op(TraceOp::GET_SELECTED_OBJECT_NUM);
+	put_int(g_trace.body, num);
+	return num;
+}
+
+static void trace_set_object_name(OBJECT_HANDLE obj, LPCWSTR name) {
+	put_op(TraceOp::SET_OBJECT_NAME);
+	put_object(obj);
+	put_uint(g_trace.body, trace_hash(name));
+	g_trace.host.set_object_name(obj, name);
+}
+
+
+bool trace_enabled() {
+	return !g_trace.path.empty();
+}
+
+
+void trace_configure(const std::filesystem::path& path) {
+	g_trace.path = path;
+}
+
+
+EDIT_SECTION* trace_begin_command(EDIT_SECTION* edit, const char* command, int scope, std::string_view match) {
+	if (!trace_enabled()) return edit;
+
+	g_trace.active = true;
+	g_trace.header.clear();
+	g_trace.body.clear();
+	g_trace.objects.clear();
+	g_trace.texts.clear();
+
+	put_bytes(g_trace.header, command);
+	put_uint(g_trace.header, scope);
+	put_bytes(g_trace.header, match);
+	put_uint(g_trace.header, edit->info ? 1 : 0);
+	if (edit->info) {
+		const EDIT_INFO& info = *edit->info;
+		put_int(g_trace.header, info.frame);
+		put_int(g_trace.header, info.layer);
+		put_int(g_trace.header, info.layer_max);
+		put_int(g_trace.header, info.select_range_start);
+		put_int(g_trace.header, info.select_range_end);
+	}
+
+	// コマンドが使う関数だけを差し替える (それ以外はホストの関数をそのまま呼ぶ)
+	g_trace.host = *edit;
+	g_trace.section = *edit;
+	g_trace.section.find_object = trace_find_object;
+	g_trace.section.get_object_layer_frame = trace_get_object_layer_frame;
+	g_trace.section.get_object_alias = trace_get_object_alias;
+	g_trace.section.create_object_from_alias = trace_create_object_from_alias;
+	g_trace.section.delete_object = trace_delete_object;
+	g_trace.section.get_focus_object = trace_get_focus_object;
+	g_trace.section.set_focus_object = trace_set_focus_object;
+	g_trace.section.get_selected_object = trace_get_selected_object;
+	g_trace.section.get_selected_object_num = trace_get_selected_object_num;
+	g_trace.section.set_object_name = trace_set_object_name;
+	return &g_trace.section;
+}
+
+
+void trace_end_command() {
+	if (!g_trace.active) return;
+	g_trace.active = false;
+	put_op(TraceOp::END);
+
+	std::ofstream out(g_trace.path, std::ios::app | std::ios::binary);
+	if (!out) return;
+	out.seekp(0, std::ios::end);
+	if (out.tellp() == std::streampos(0)) out.write(TRACE_MAGIC, TRACE_MAGIC_SIZE);
+	out.write(g_trace.header.data(), g_trace.header.size());
+	out.write(g_trace.body.data(), g_trace.body.size());
+}
+
+
+// --- 読み込み ---
+
+/// コマンド1回分を読み込む
+/// @return 最後まで読めたか
+static bool read_command(TraceReader& in, TraceCommand& command) {
+	command.name = in.get_bytes();
+	command.scope = (int)in.get_uint();
+	command.match = in.get_bytes();
+	command.has_info = in.get_uint() != 0;
+	if (command.has_info) {
+		command.info.frame = (int)in.get_int();
+		command.info.layer = (int)in.get_int();
+		command.info.layer_max = (int)in.get_int();
+		command.info.select_range_start = (int)in.get_int();
+		command.info.select_range_end = (int)in.get_int();
+	}
+
+	while (in.ok && in.p != in.end) {
+		TraceCall call;
+		call.op = (TraceOp)*in.p++;
+		switch (call.op) {
+		case TraceOp::END:
+			return true;
+		case TraceOp::FIND_OBJECT:
+			call.args[0] = (int)in.get_int();
+			call.args[1] = (int)in.get_int();
+			call.result = (uint32_t)in.get_uint();
+			break;
+		case TraceOp::GET_LAYER_FRAME:
+			call.object = (uint32_t)in.get_uint();
+			call.lf.layer = (int)in.get_int();
+			call.lf.start = (int)in.get_int();
+			call.lf.end = (int)in.get_int();
+			break;
+		case TraceOp::GET_ALIAS:
+			call.object = (uint32_t)in.get_uint();
+			call.value = (int)in.get_uint();
+			if (call.value == (int)command.texts.size() + 1) {
+				command.texts.emplace_back(in.get_bytes());
+			}
+			else if (call.value > (int)command.texts.size()) {
+				in.ok = false;
+			}
+			break;
+		case TraceOp::CREATE_OBJECT:
+			call.hash = in.get_uint();
+			call.args[0] = (int)in.get_int();
+			call.args[1] = (int)in.get_int();
+			call.args[2] = (int)in.get_int();
+			call.result = (uint32_t)in.get_uint();
+			break;
+		case TraceOp::DELETE_OBJECT:
+		case TraceOp::SET_FOCUS_OBJECT:
+			call.object = (uint32_t)in.get_uint();
+			break;
+		case TraceOp::GET_FOCUS_OBJECT:
+			call.result = (uint32_t)in.get_uint();
+			break;
+		case TraceOp::GET_SELECTED_OBJECT:
+			call.args[0] = (int)in.get_int();
+			call.result = (uint32_t)in.get_uint();
+			break;
+		case TraceOp::GET_SELECTED_OBJECT_NUM:
+			call.value = (int)in.get_int();
+			break;
+		case TraceOp::SET_OBJECT_NAME:
+			call.object = (uint32_t)in.get_uint();
+			call.hash = in.get_uint();
+			break;
+		default:
+			return false;
+		}
+		command.calls.push_back(call);
+	}
+	return false;
+}
+
+
+std::vector<TraceCommand> trace_load(const std::filesystem::path& path) {
+	std::vector<TraceCommand> commands;
+	std::ifstream file(path, std::ios::binary);
+	std::string data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+	if (data.compare(0, TRACE_MAGIC_SIZE, TRACE_MAGIC) != 0) return commands;
+
+	TraceReader in = { data.data() + TRACE_MAGIC_SIZE, data.data() + data.size() };
+	while (in.p != in.end) {
+		TraceCommand command;
+		if (!read_command(in, command) || !in.ok) break;
+		commands.push_back(std::move(command));
+	}
+	return commands;
+}
+
+
+// --- 再生 ---
+
+/// 再生中のコマンド
+static TraceReplay* g_replay = nullptr;
+
+static OBJECT_HANDLE to_handle(uint32_t id) {
+	return (OBJECT_HANDLE)(uintptr_t)id;
+}
+
+static uint32_t to_id(OBJECT_HANDLE obj) {
+	return (uint32_t)(uintptr_t)obj;
+}
+
+
+/// 再生に使う EDIT_SECTION の関数
+/// 呼び出しの種類と引数が記録と一致すれば記録した戻り値を返し、異なれば以降の再生をやめる
+struct TraceReplayAccess {
+	static const TraceCall* next(TraceOp op, uint32_t object = 0, int arg0 = 0, int arg1 = 0, int arg2 = 0) {
+		auto call = g_replay->next(op);
+		if (!call) return nullptr;
+		if (call->object != object || call->args[0] != arg0 || call->args[1] != arg1 || call->args[2] != arg2) {
+			g_replay->stats.diverged_at = g_replay->cursor - 1;
+			return nullptr;
+		}
+		return call;
+	}
+
+	static OBJECT_HANDLE find_object(int layer, int frame) {
+		auto call = next(TraceOp::FIND_OBJECT, 0, layer, frame);
+		return call ? to_handle(call->result) : nullptr;
+	}
+
+	static OBJECT_LAYER_FRAME get_object_layer_frame(OBJECT_HANDLE obj) {
+		auto call = next(TraceOp::GET_LAYER_FRAME, to_id(obj));
+		return call ? call->lf : OBJECT_LAYER_FRAME{};
+	}
+
+	static LPCSTR get_object_alias(OBJECT_HANDLE obj) {
+		auto call = next(TraceOp::GET_ALIAS, to_id(obj));
+		if (!call || call->value == 0) return nullptr;
+		return g_replay->command.texts[call->value - 1].c_str();
+	}
+
+	static OBJECT_HANDLE create_object_from_alias(LPCSTR alias, int layer, int frame, int length) {
+		auto call = next(TraceOp::CREATE_OBJECT, 0, layer, frame, length);
+		if (!call) return nullptr;
+		if (call->hash != trace_hash(alias)) g_replay->stats.alias_mismatches++;
+		return to_handle(call->result);
+	}
+
+	static void delete_object(OBJECT_HANDLE obj) {
+		next(TraceOp::DELETE_OBJECT, to_id(obj));
+	}
+
+	static OBJECT_HANDLE get_focus_object() {
+		auto call = next(TraceOp::GET_FOCUS_OBJECT);
+		return call ? to_handle(call->result) : nullptr;
+	}
+
+	static void set_focus_object(OBJECT_HANDLE obj) {
+		next(TraceOp::SET_FOCUS_OBJECT, to_id(obj));
+	}
+
+	static OBJECT_HANDLE get_selected_object(int index) {
+		auto call = next(TraceOp::GET_SELECTED_OBJECT, 0, index);
+		return call ? to_handle(call->result) : nullptr;
+	}
+
+	static int get_selected_object_num() {
+		auto call = next(TraceOp::GET_SELECTED_OBJECT_NUM);
+		return call ? call->value : 0;
+	}
+
+	static void set_object_name(OBJECT_HANDLE obj, LPCWSTR name) {
+		auto call = next(TraceOp::SET_OBJECT_NAME, to_id(obj));
+		if (call && call->hash != trace_hash(name)) g_replay->stats.alias_mismatches++;
+	}
+};
+
+
+TraceReplay::TraceReplay(const TraceCommand& command)
+	: command(command), info(command.info), section() {
+	// 記録しない関数はコマンドから呼び出されないため nullptr のままにする
+	section.info = command.has_info ? &info : nullptr;
+	section.find_object = TraceReplayAccess::find_object;
+	section.get_object_layer_frame = TraceReplayAccess::get_object_layer_frame;
+	section.get_object_alias = TraceReplayAccess::get_object_alias;
+	section.create_object_from_alias = TraceReplayAccess::create_object_from_alias;
+	section.delete_object = TraceReplayAccess::delete_object;
+	section.get_focus_object = TraceReplayAccess::get_focus_object;
+	section.set_focus_object = TraceReplayAccess::set_focus_object;
+	section.get_selected_object = TraceReplayAccess::get_selected_object;
+	section.get_selected_object_num = TraceReplayAccess::get_selected_object_num;
+	section.set_object_name = TraceReplayAccess::set_object_name;
+	g_replay = this;
+}
+
+
+TraceReplay::~TraceReplay() {
+	if (g_replay == this) g_replay = nullptr;
+}
+
+
+/// 次の記録を取り出す
+/// @return 種類が一致すれば記録 (異なるか、再生をやめていれば nullptr)
+const TraceCall* TraceReplay::next(TraceOp op) {
+	if (stats.diverged_at != SIZE_MAX) return nullptr;
+	if (cursor >= command.calls.size() || command.calls[cursor].op != op) {
+		stats.diverged_at = cursor;
+		return nullptr;
+	}
+	return &command.calls[cursor++];
+}
+
+
+TraceReplayResult TraceReplay::result() const {
+	TraceReplayResult result = stats;
+	if (result.diverged_at == SIZE_MAX) {
+		result.calls = cursor;
+		result.unused = command.calls.size() - cursor;
+	}
+	else {
+		result.calls = result.diverged_at;
+	}
+	return result;
+}
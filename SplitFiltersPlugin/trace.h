@@ -0,0 +1,108 @@
+#pragma once
+#include "host_api.h"
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// --- EDIT_SECTION 呼び出しの記録・再生 ---
+// 記録時は、コマンドが使う EDIT_SECTION を呼び出しを記録するものに差し替え、
+// 引数と戻り値 (エイリアス、レイヤー・フレームを含む) をコマンドごとにファイルへ追記する
+// 再生時は、記録した戻り値を順に返す EDIT_SECTION でコマンドを実行し、実際のタイムラインなしで同じ処理を再現する
+// (解析・配置の計測や、作成したエイリアスが変わっていないかの確認に使う)
+// 学習したエフェクトの種類などで呼び出しが変わるため、再生はプラグインを読み込んだ直後の状態から、記録した順に行う
+
+/// 記録する EDIT_SECTION の関数
+enum class TraceOp : uint8_t {
+	END,						// コマンドの終わり
+	FIND_OBJECT,
+	GET_LAYER_FRAME,
+	GET_ALIAS,
+	CREATE_OBJECT,
+	DELETE_OBJECT,
+	GET_FOCUS_OBJECT,
+	SET_FOCUS_OBJECT,
+	GET_SELECTED_OBJECT,
+	GET_SELECTED_OBJECT_NUM,
+	SET_OBJECT_NAME,
+	COUNT
+};
+
+/// 記録が有効か
+bool trace_enabled();
+
+/// 記録の設定を行う
+/// @param path 記録を追記するファイル (空なら記録しない)
+void trace_configure(const std::filesystem::path& path);
+
+/// コマンドの記録を開始する
+/// @param command コマンド名
+/// @param scope 対象範囲 (TargetScope)
+/// @param match 「フィルタ分離（指定フィルタのみ）」の条件
+/// @return 呼び出しを記録する EDIT_SECTION (記録が無効なら edit をそのまま返す)
+EDIT_SECTION* trace_begin_command(EDIT_SECTION* edit, const char* command, int scope, std::string_view match);
+/// コマンドの記録を終了し、ファイルに追記する
+void trace_end_command();
+
+
+/// 記録したホスト呼び出し1回分
+/// オブジェクトは記録したコマンド内で振った ID (1～、nullptr は 0) で表す
+struct TraceCall {
+	TraceOp op = TraceOp::END;
+	uint32_t object = 0;			// 引数のオブジェクト
+	uint32_t result = 0;			// 戻り値のオブジェクト
+	int args[3] = {};				// layer, frame, length / 選択オブジェクトの番号
+	OBJECT_LAYER_FRAME lf = {};		// GET_LAYER_FRAME の戻り値
+	int value = 0;					// GET_SELECTED_OBJECT_NUM の戻り値 / GET_ALIAS の戻り値 (texts の番号+1、nullptr は 0)
+	uint64_t hash = 0;				// CREATE_OBJECT のエイリアス / SET_OBJECT_NAME の名前のハッシュ値
+};
+
+/// 記録したコマンド1回分
+struct TraceCommand {
+	std::string name;
+	int scope = 0;
+	std::string match;
+	bool has_info = false;
+	EDIT_INFO info = {};				// コマンドが参照する項目のみ
+	std::vector<std::string> texts;		// GET_ALIAS が返したエイリアス (同じ内容は1つにまとめる)
+	std::vector<TraceCall> calls;
+};
+
+/// 記録ファイルを読み込む
+/// @return 記録したコマンド (読み込めない部分以降は含まない)
+std::vector<TraceCommand> trace_load(const std::filesystem::path& path);
+
+
+/// 再生結果
+struct TraceReplayResult {
+	size_t calls = 0;				// 記録どおりに再生できた呼び出しの数
+	size_t diverged_at = SIZE_MAX;	// 記録と異なる呼び出しをした位置 (なければ SIZE_MAX)
+	size_t unused = 0;				// 呼び出されなかった記録の数
+	size_t alias_mismatches = 0;	// 作成したエイリアスが記録と異なった回数
+	bool matched() const { return diverged_at == SIZE_MAX && unused == 0 && alias_mismatches == 0; }
+};
+
+/// 記録したコマンド1回分を再生する EDIT_SECTION
+/// 関数に状態を渡せないため、同時に作成できるのは1つだけ
+/// 記録と異なる呼び出しをした以降は、すべて nullptr / 0 を返す
+class TraceReplay {
+public:
+	explicit TraceReplay(const TraceCommand& command);
+	~TraceReplay();
+	TraceReplay(const TraceReplay&) = delete;
+	TraceReplay& operator=(const TraceReplay&) = delete;
+
+	EDIT_SECTION* edit() { return &section; }
+	TraceReplayResult result() const;
+
+private:
+	friend struct TraceReplayAccess;
+	const TraceCall* next(TraceOp op);
+
+	const TraceCommand& command;
+	EDIT_INFO info;
+	EDIT_SECTION section;
+	size_t cursor = 0;
+	TraceReplayResult stats;
+};
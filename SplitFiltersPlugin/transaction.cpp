@@ -0,0 +1,157 @@
+#include "transaction.h"
+#include "host.h"
+
+EditTransaction::EditTransaction()
+	: ops(command_resource()), replaced(command_resource()) {
+}
+
+
+int EditTransaction::create(std::shared_ptr<const std::string> alias, const OBJECT_LAYER_FRAME& lf) {
+	Op op;
+	op.type = OpType::CREATE;
+	op.lf = lf;
+	op.target = {};
+	op.alias = std::move(alias);
+	ops.push_back(std::move(op));
+	return (int)ops.size() - 1;
+}
+
+
+int EditTransaction::replace(const TargetObject& target, std::shared_ptr<const std::string> alias) {
+	Op op;
+	op.type = OpType::REPLACE;
+	op.lf = target.lf;
+	op.target = target;
+	op.alias = std::move(alias);
+	ops.push_back(std::move(op));
+	return (int)ops.size() - 1;
+}
+
+
+int EditTransaction::remove(const TargetObject& target) {
+	Op op;
+	op.type = OpType::REMOVE;
+	op.lf = target.lf;
+	op.target = target;
+	ops.push_back(std::move(op));
+	return (int)ops.size() - 1;
+}
+
+
+void EditTransaction::set_fallback(std::shared_ptr<const std::string> alias) {
+	if (!ops.empty()) ops.back().fallback_alias = std::move(alias);
+}
+
+
+void EditTransaction::set_alias(int op_index, std::shared_ptr<const std::string> alias) {
+	ops[op_index].alias = std::move(alias);
+	ops[op_index].fallback_alias.reset();
+}
+
+
+const std::string& EditTransaction::alias(int op_index) const {
+	static const std::string empty;
+	return ops[op_index].alias ? *ops[op_index].alias : empty;
+}
+
+
+/// 操作のエイリアスでオブジェクトを作成する (失敗したら代わりのエイリアスで作成する)
+OBJECT_HANDLE EditTransaction::create_object(EDIT_SECTION* edit, Op& op) {
+	const int length = op.lf.end - op.lf.start;
+	auto obj = host_create_object_from_alias(edit, op.alias->c_str(), op.lf.layer, op.lf.start, length);
+	if (!obj && op.fallback_alias && !op.fallback_alias->empty()) {
+		obj = host_create_object_from_alias(edit, op.fallback_alias->c_str(), op.lf.layer, op.lf.start, length);
+		op.used_fallback = obj != nullptr;
+	}
+	return obj;
+}
+
+
+/// 1つの操作を適用する
+/// @return 成功すれば true (失敗した場合、この操作による変更は残らない)
+bool EditTransaction::apply_op(EDIT_SECTION* edit, LayerOccupancy& occupancy, Op& op) {
+	switch (op.type) {
+	case OpType::CREATE:
+		op.result = create_object(edit, op);
+		if (!op.result) {
+			occupancy.remove(op.lf);
+			return false;
+		}
+		op.changed = true;
+		occupancy.add(op.lf, op.result);
+		return true;
+
+	case OpType::REPLACE:
+		// エイリアスが変わらなければホストを呼び出さない
+		if (op.alias == op.target.alias || *op.alias == *op.target.alias) {
+			op.result = op.target.obj;
+			return true;
+		}
+		host_delete_object(edit, op.target.obj);
+		occupancy.remove(op.lf);
+		replaced.push_back(op.target.obj);
+
+		op.result = create_object(edit, op);
+		if (!op.result) {
+			// 元のオブジェクトを作成し直す
+			if (auto restored = host_create_object_from_alias(edit, op.target.alias->c_str(), op.lf.layer, op.lf.start, op.lf.end - op.lf.start)) {
+				occupancy.add(op.lf, restored);
+			}
+			else {
+				rollback_ok = false;
+			}
+			return false;
+		}
+		op.changed = true;
+		occupancy.add(op.lf, op.result);
+		return true;
+
+	case OpType::REMOVE:
+		host_delete_object(edit, op.target.obj);
+		occupancy.remove(op.lf);
+		replaced.push_back(op.target.obj);
+		op.changed = true;
+		return true;
+	}
+	return false;
+}
+
+
+/// 適用済みの操作を取り消す
+void EditTransaction::undo_op(EDIT_SECTION* edit, LayerOccupancy& occupancy, Op& op) {
+	if (!op.changed) return;
+
+	// 作成したオブジェクトを削除する
+	if (op.result) {
+		host_delete_object(edit, op.result);
+		occupancy.remove(op.lf);
+	}
+
+	// 削除したオブジェクトを作成し直す
+	if (op.type != OpType::CREATE) {
+		if (auto restored = host_create_object_from_alias(edit, op.target.alias->c_str(), op.lf.layer, op.lf.start, op.lf.end - op.lf.start)) {
+			occupancy.add(op.lf, restored);
+		}
+		else {
+			rollback_ok = false;
+		}
+	}
+	op.changed = false;
+}
+
+
+/// 計画した操作を順に適用する
+/// 失敗した場合は、それまでに適用した操作を逆順に取り消す
+/// @return すべて成功すれば true
+bool EditTransaction::apply(EDIT_SECTION* edit, LayerOccupancy& occupancy) {
+	for (int i = 0; i < (int)ops.size(); i++) {
+		if (apply_op(edit, occupancy, ops[i])) continue;
+
+		failed_index = i;
+		for (int j = i - 1; j >= 0; j--) {
+			undo_op(edit, occupancy, ops[j]);
+		}
+		return false;
+	}
+	return true;
+}
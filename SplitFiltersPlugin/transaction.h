@@ -0,0 +1,67 @@
+#pragma once
+#include "timeline.h"
+
+/// 1オブジェクト分のタイムライン変更
+/// 操作をすべて計画してから順に適用し、途中で失敗したら適用済みの操作を逆順に取り消す
+/// 操作の記録はコマンドの作業領域 (command_resource) から確保する
+class EditTransaction {
+public:
+	EditTransaction();
+
+	/// 空き位置へのオブジェクト作成を計画に追加する
+	/// @return 操作のインデックス
+	int create(std::shared_ptr<const std::string> alias, const OBJECT_LAYER_FRAME& lf);
+	/// オブジェクトの置き換えを計画に追加する (エイリアスが変わらなければ何もしない)
+	/// @return 操作のインデックス
+	int replace(const TargetObject& target, std::shared_ptr<const std::string> alias);
+	/// オブジェクトの削除を計画に追加する
+	/// @return 操作のインデックス
+	int remove(const TargetObject& target);
+	/// 操作の数が分かっている場合に、あらかじめ確保しておく
+	void reserve(size_t op_count) { ops.reserve(op_count); }
+	/// 作成時に失敗した場合に代わりに使うエイリアスを、直前の操作に設定する
+	void set_fallback(std::shared_ptr<const std::string> alias);
+
+	/// 操作で作成するエイリアスを差し替える (代わりのエイリアスは使わなくなる)
+	void set_alias(int op_index, std::shared_ptr<const std::string> alias);
+
+	/// 計画を適用する
+	/// @return すべて成功すれば true (失敗した場合は元の状態に戻している)
+	bool apply(EDIT_SECTION* edit, LayerOccupancy& occupancy);
+
+	bool empty() const { return ops.empty(); }
+	/// 操作によって作成されたオブジェクト (置き換えでエイリアスが変わらなければ元のオブジェクト)
+	OBJECT_HANDLE result(int op_index) const { return ops[op_index].result; }
+	/// 操作で代わりのエイリアスを使って作成したか
+	bool used_fallback(int op_index) const { return ops[op_index].used_fallback; }
+	/// 操作で作成するエイリアス
+	const std::string& alias(int op_index) const;
+	/// 失敗した操作のインデックス (失敗していなければ -1)
+	int failed_op() const { return failed_index; }
+	/// 失敗時に元の状態へ戻せたか
+	bool rolled_back() const { return rollback_ok; }
+	/// 適用中に削除された元のオブジェクト (復元された場合もハンドルは変わる)
+	const std::pmr::vector<OBJECT_HANDLE>& replaced_objects() const { return replaced; }
+
+private:
+	enum class OpType { CREATE, REPLACE, REMOVE };
+	struct Op {
+		OpType type;
+		OBJECT_LAYER_FRAME lf;
+		TargetObject target;		// REPLACE / REMOVE の対象
+		std::shared_ptr<const std::string> alias;	// CREATE / REPLACE で作成するエイリアス (作成時に解析済みキャッシュと共有する)
+		std::shared_ptr<const std::string> fallback_alias;
+		OBJECT_HANDLE result = nullptr;
+		bool changed = false;		// ホストに変更を加えたか
+		bool used_fallback = false;	// 代わりのエイリアスで作成したか
+	};
+
+	bool apply_op(EDIT_SECTION* edit, LayerOccupancy& occupancy, Op& op);
+	void undo_op(EDIT_SECTION* edit, LayerOccupancy& occupancy, Op& op);
+	OBJECT_HANDLE create_object(EDIT_SECTION* edit, Op& op);
+
+	std::pmr::vector<Op> ops;
+	std::pmr::vector<OBJECT_HANDLE> replaced;
+	int failed_index = -1;
+	bool rollback_ok = true;
+};
@@ -1,5 +1,6 @@
 #include "util.h"
 
+#ifdef _WIN32
 /// AviUtl2 のメインウィンドウを取得する
 HWND get_aviutl2_window() {
 	const std::wstring className = L"aviutl2Manager";
@@ -28,302 +29,121 @@ std::wstring utf8_to_wide(const std::string& s) {
 }
 
 
-/// [Object] ヘッダを抜き出す
-/// @param alias エイリアスデータ
-/// @return [Object] ～ [Object.0] の直前までのエイリアスデータ
-std::string extract_object_header(const std::string& alias) {
-	size_t header_start = alias.find("[Object]");
-	if (header_start == std::string::npos) return "";
-
-	size_t obj0_start = alias.find("[Object.0]");
-	if (obj0_start == std::string::npos) return "";
-
-	return alias.substr(header_start, obj0_start - header_start);
+/// std::wstringを、UTF-8のstd::stringに変換する
+std::string wide_to_utf8(const std::wstring& s) {
+	size_t size = WideCharToMultiByte(CP_UTF8, 0, s.c_str(), s.size(), NULL, 0, NULL, NULL);
+	std::string result(size, 0);
+	WideCharToMultiByte(CP_UTF8, 0, s.c_str(), s.size(), &result[0], size, NULL, NULL);
+	return result;
 }
 
 
-/// 指定された位置が行頭であるかを判定する
-/// @param head 判定を行うインデックス
-/// @return head の直前の文字が'\\n'であれば true
-static bool is_at_line_start(const std::string& text, size_t head) {
-	// 直前が \n の場合
-	if (head > 0) {
-		if (text[head - 1] == '\n') {
-			return true;
-		}
-	}
-	return false;
+void notify_beep() {
+	MessageBeep(-1);
 }
 
 
-/// [Object.x] を展開し、ObjSec ベクターに格納
-/// @param alias エイリアスデータ
-/// @return 解析済みの ObjSec ベクター
-std::vector<ObjSec> parse_objects(const std::string& alias) {
-	std::vector<ObjSec> out;
-
-	// [Object.0]以降を探すように初期化
-	size_t start_pos = alias.find("[Object.0]");
-	if (start_pos == std::string::npos) {
-		return out;
-	}
-
-	const std::string& text_to_parse = alias;
-	size_t pos = start_pos;
-
-	// --- [Object.x] セクションの繰り返し処理 ---
-	while (pos < text_to_parse.size()) {
-		// 現在位置から次の [Object. を探す
-		size_t head = text_to_parse.find("[Object.", pos);
-		if (head == std::string::npos) break;
-
-		// 行頭の [Object.x] でない場合は無視
-		if (!is_at_line_start(text_to_parse, head)) {
-			pos = head + 1;
-			continue;
-		}
-
-		// セクションヘッダーの ] を探す
-		size_t bracket_end = text_to_parse.find("]", head);
-		if (bracket_end == std::string::npos) break;
-
-		// 現在セクションの次の [Object. を見つける
-		size_t next_head = std::string::npos;
-		size_t search_pos = bracket_end + 1;
-		while (search_pos < text_to_parse.size()) {
-			size_t potential_next = text_to_parse.find("[Object.", search_pos);
-			if (potential_next == std::string::npos) break;
-
-			// 行頭チェック
-			if (is_at_line_start(text_to_parse, potential_next)) {
-				next_head = potential_next;
-				break;
-			}
-			search_pos = potential_next + 1;
-		}
+/// 予約したタイマーと呼び出す関数
+static UINT_PTR g_deferred_timer = 0;
+static void (*g_deferred_callback)() = nullptr;
 
-		// 次の [Object. が見つからなかった場合、文字列の末尾まで
-		if (next_head == std::string::npos) {
-			next_head = text_to_parse.size();
-		}
-
-
-		// セクションごとにObjSecへパースする
-		std::string sec = text_to_parse.substr(head, next_head - head);
-
-		// インデックス番号を抽出
-		const int prefix_len = 8;
-		std::string num_str = text_to_parse.substr(head + prefix_len, bracket_end - (head + prefix_len));
-		int idx = std::stoi(num_str);
-
-		// effect.name の値を抽出
-		std::string effect_name;
-		const char* effect_key = "effect.name=";
-		size_t efp = sec.find(effect_key);
-		if (efp != std::string::npos) {
-			efp += std::strlen(effect_key);
-			size_t eol = sec.find('\r', efp);
-			if (eol != std::string::npos) {
-				effect_name = sec.substr(efp, eol - efp);
-			}
-		}
-
-		// 抽出した情報を結果ベクタに追加し、次の検索位置を更新する
-		out.push_back({ sec, idx, effect_name });
-		pos = next_head;
-	}
-
-	return out;
+static void CALLBACK deferred_timer_proc(HWND, UINT, UINT_PTR id, DWORD) {
+	KillTimer(nullptr, id);
+	if (id != g_deferred_timer) return;
+	g_deferred_timer = 0;
+	auto callback = g_deferred_callback;
+	g_deferred_callback = nullptr;
+	if (callback) callback();
 }
 
 
-/// フィルタ効果の開始インデックスを計算
-/// @param objs 解析済みの ObjSec ベクター
-/// @param include_self_filter 自身のフィルタ効果を対象にするか
-/// @return 2 または 1
-int calc_start_index(const std::vector<ObjSec>& objs, bool include_self_filter) {
-	if (include_self_filter) {
-		if (has_output_section(objs)) {
-			// 出力切り替えセクションがある場合、フィルタ効果は[Object.2]以降
-			return 2;
-		}
-		else if (is_none_output_object(objs)){
-			// 特殊メディアオブジェクトかフィルタオブジェクトの場合、フィルタ効果は[Object.1]以降
-			return 1;
-		}
-		else {
-			// それ以外(フィルタ効果)は[Object.0]以降
-			return 0;
-		}
-	}
-	else {
-		// フィルタオブジェクトなら、追加フィルタ効果は[Object.2]以降
-		if (objs[0].effect_name == u8"フィルタオブジェクト") return 2;
-
-		// 自身のフィルタ効果を対象にしない場合、追加フィルタ効果は[Object.1] (+出力切り替えセクション) 以降
-		return 1 + has_output_section(objs);
-	}
+bool schedule_deferred_call(unsigned int delay_ms, void (*callback)()) {
+	cancel_deferred_call();
+	g_deferred_callback = callback;
+	g_deferred_timer = SetTimer(nullptr, 0, delay_ms, deferred_timer_proc);
+	return g_deferred_timer != 0;
 }
 
 
-/// 出力切り替えセクションがあるかを判定
-/// @param objs 解析済みの ObjSec ベクター
-/// @return true/false
-bool has_output_section(const std::vector<ObjSec>& objs) {
-	for (auto& s : OUTPUT_SECTION_LIST) {
-		if (objs[1].effect_name == s) return true;
+void cancel_deferred_call() {
+	if (g_deferred_timer) {
+		KillTimer(nullptr, g_deferred_timer);
+		g_deferred_timer = 0;
 	}
-	return false;
+	g_deferred_callback = nullptr;
 }
 
+#else
 
-/// 特殊メディアオブジェクトか判定 (グループ制御や部分フィルタなど、出力切り替えセクションを持たないもの)
-/// @param objs 解析済みの ObjSec ベクター
-/// @return true/false
-bool is_none_output_object(const std::vector<ObjSec>& objs) {
-	for (auto& s : NON_OUTPUT_SECTION_OBJECT_LIST) {
-		if (objs[0].effect_name == s) return true;
+/// UTF-8のstd::stringを、std::wstringに変換する (wchar_t は UTF-32)
+std::wstring utf8_to_wide(const std::string& s) {
+	std::wstring result;
+	result.reserve(s.size());
+	for (size_t i = 0; i < s.size(); ) {
+		unsigned char c = (unsigned char)s[i];
+		size_t len = c < 0x80 ? 1 : c < 0xE0 ? 2 : c < 0xF0 ? 3 : 4;
+		uint32_t cp = len == 1 ? c : len == 2 ? (c & 0x1F) : len == 3 ? (c & 0x0F) : (c & 0x07);
+		for (size_t k = 1; k < len && i + k < s.size(); k++) cp = (cp << 6) | ((unsigned char)s[i + k] & 0x3F);
+		result += (wchar_t)cp;
+		i += len;
 	}
-	return false;
+	return result;
 }
 
 
-/// ObjSec からエイリアスデータを再構築する
-/// @param objs 処理対象の ObjSec
-/// @param start_index 再構築処理を開始する ObjSec のインデックス
-/// @param base_index 新しい [Object.x] の基点
-/// @return 再構築されたエイリアスデータ
-std::string rebuild_alias(
-	const std::vector<ObjSec>& objs,
-	int start_index,
-	int base_index
-) {
-	if (start_index >= objs.size()) return "";
-
-	std::string result = "";
-
-	int new_idx = base_index;
-
-	for (int i = start_index; i < objs.size(); i++) {
-		char new_head[32];
-		sprintf_s(new_head, "[Object.%d]", new_idx);
-		new_idx++;
-
-		std::string sec = objs[i].sec;
-		size_t old_end = sec.find("]");
-		result += std::string(new_head) + sec.substr(old_end + 1);
+/// std::wstringを、UTF-8のstd::stringに変換する (wchar_t は UTF-32)
+std::string wide_to_utf8(const std::wstring& s) {
+	std::string result;
+	result.reserve(s.size());
+	for (wchar_t wc : s) {
+		uint32_t cp = (uint32_t)wc;
+		if (cp < 0x80) {
+			result += (char)cp;
+		}
+		else if (cp < 0x800) {
+			result += (char)(0xC0 | (cp >> 6));
+			result += (char)(0x80 | (cp & 0x3F));
+		}
+		else if (cp < 0x10000) {
+			result += (char)(0xE0 | (cp >> 12));
+			result += (char)(0x80 | ((cp >> 6) & 0x3F));
+			result += (char)(0x80 | (cp & 0x3F));
+		}
+		else {
+			result += (char)(0xF0 | (cp >> 18));
+			result += (char)(0x80 | ((cp >> 12) & 0x3F));
+			result += (char)(0x80 | ((cp >> 6) & 0x3F));
+			result += (char)(0x80 | (cp & 0x3F));
+		}
 	}
 	return result;
 }
 
 
-/// エイリアスに付くフィルタを抽出して、フィルタ効果オブジェクトを作成
-/// @param alias: エイリアスデータ
-/// @return フィルタ効果オブジェクトのエイリアスデータ
-std::string build_target_alias(const std::string alias) {
-	std::string header = extract_object_header(alias);
-	const auto objs = parse_objects(alias);
-	if (objs.empty()) return "";
-
-	int start = calc_start_index(objs);
-
-	// 再構築 [Object]～[Object.0]～[Object.n]
-	if (objs[0].effect_name == "フィルタオブジェクト") {
-		return header + FILTER_OBJECT_OBJ0 + rebuild_alias(objs, start, 1);
-	}
-	else {
-		return header + rebuild_alias(objs, start, 0);
-	}
+void notify_beep() {
 }
 
 
-/// エイリアスに付くフィルタを抽出して、フィルタ効果群を作成（グループ制御に紐づける用）
-/// @param alias: エイリアスデータ
-/// @return フィルタ効果オブジェクト群を含むエイリアス文字列。
-static std::string build_target_alias_group(const std::string alias) {
-	auto objs = parse_objects(alias);
-	if (objs.empty()) return "";
+/// 予約した呼び出し
+static void (*g_deferred_callback)() = nullptr;
 
-	int start = calc_start_index(objs);
-
-	// 再構築 [Object.1]～[Object.n]
-	return rebuild_alias(objs, start, 1);
+bool schedule_deferred_call(unsigned int, void (*callback)()) {
+	g_deferred_callback = callback;
+	return true;
 }
 
 
-/// エイリアスに付くフィルタを抽出して、グループ制御オブジェクトを作成
-/// @param edit: 編集セクション構造体
-/// @param alias: エイリアスデータ
-/// @return グループ制御オブジェクトのハンドル (作成できなければ nullptr)
-OBJECT_HANDLE try_create_group(
-	EDIT_SECTION* edit,
-	const std::string& alias,
-	int layer, int start, int length)
-{
-	// [Object] ヘッダを抽出
-	std::string header = extract_object_header(alias);
-
-	// [Object.1]～ を作成
-	std::string obj1 = build_target_alias_group(alias);
-
-	// グループ制御を作成
-	{
-		std::string a = header + std::string(GROUP_OBJ0) + obj1;
-		auto o = edit->create_object_from_alias(a.c_str(), layer, start, length);
-		if (o) return o;
-	}
-
-	// 上記がdifferent effect typeで作成できなかったら、グループ制御(音声) を作る
-	{
-		std::string a = header + std::string(GROUP_AUDIO_OBJ0) + obj1;
-		auto o = edit->create_object_from_alias(a.c_str(), layer, start, length);
-		if (o) return o;
-	}
-
-	return nullptr;
+void cancel_deferred_call() {
+	g_deferred_callback = nullptr;
 }
 
 
-/// 元オブジェクトから分離フィルタを削除したものを作成
-/// @param alias: エイリアスデータ
-std::string build_source_alias(const std::string alias) {
-	// エイリアスデータをパース
-	const auto objs = parse_objects(alias);
-	if (objs.empty()) return "";
-
-	// フィルタ効果の開始地点までを対象
-	const int max_idx = calc_start_index(objs);
-
-	// オブジェクトの再構築
-	std::string header = extract_object_header(alias);
-
-	// [Object.0] ～ [Object.0 or 1] までを切り出す
-	std::vector<ObjSec> filtered_objs;
-	filtered_objs.assign(objs.begin(), objs.begin() + max_idx);
-
-	return header + rebuild_alias(filtered_objs, 0, 0);
+bool run_deferred_call() {
+	auto callback = g_deferred_callback;
+	g_deferred_callback = nullptr;
+	if (!callback) return false;
+	callback();
+	return true;
 }
 
-
-/// 指定範囲に被らない最初のレイヤーを返す
-/// @param edit 編集セクションハンドル
-/// @param start_layer 探索を開始するレイヤー（通常は元レイヤー+1）
-/// @param start_frame 探索対象の開始フレーム
-/// @param end_frame 探索対象の終了フレーム（開始 + 長さ）
-int find_available_layer(EDIT_SECTION* edit, int start_layer, int start_frame, int end_frame) {
-	for (int layer = start_layer; layer < SAFE_LAYER_LIMIT; ++layer) {
-		auto obj = edit->find_object(layer, start_frame);
-		if (!obj) {
-			// 指定フレームにオブジェクトが無ければそのレイヤーは使える
-			return layer;
-		}
-		auto lf = edit->get_object_layer_frame(obj);
-		// 重複判定: 範囲が交差するなら不可
-		// 交差しない条件: (lf.end <= start_frame) || (lf.start >= end_frame)
-		if (lf.end < start_frame || lf.start > end_frame) {
-			return layer;
-		}
-		// 交差する場合は次のレイヤーを試す
-	}
-	return -1;
-}
\ No newline at end of file
+#endif
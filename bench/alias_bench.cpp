@@ -0,0 +1,197 @@
+#include "alias.h"
+#include "alias_cache.h"
+#include "thread_pool.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+// --- エイリアスの解析・組み立てのベンチマーク ---
+// 合成したタイムライン (メディアオブジェクト・フィルタオブジェクト・グループ制御) のエイリアスを
+// make_split_plan で解析し、セクションのパラメータを引く時間と、各コマンドが作成するエイリアスを組み立てる時間を計る
+// 最後に、コマンドの並列段階 (解析と組み立て) を parallel_for で 1/2/4/8 スレッドに分けたときの時間を計る
+// 使い方: alias_bench [オブジェクト数] [繰り返し回数]
+
+/// 合成するオブジェクトの種類
+enum class SyntheticKind {
+	TEXT,
+	AUDIO,
+	FILTER_OBJECT,
+	GROUP
+};
+
+/// 1オブジェクト分のエイリアスを作成する
+/// 値はオブジェクトごとに変え、同じ内容のエイリアスがキャッシュに当たらないようにする
+static std::string make_alias(SyntheticKind kind, int index, int filters, size_t text_size) {
+	const std::string n = std::to_string(index);
+	std::string a = "[Object]\nlayer=" + std::to_string(index % 100 + 1) + "\nframe=" + n + "0," + n + "9\n";
+	int sec = 0;
+	auto section = [&](const char* effect_name) {
+		a += "[Object." + std::to_string(sec++) + "]\neffect.name=";
+		a += effect_name;
+		a += "\n";
+	};
+
+	switch (kind) {
+	case SyntheticKind::TEXT:
+		section(u8"テキスト");
+		a += u8"テキスト=" + std::string(text_size, 'a') + n + "\n";
+		section(u8"標準描画");
+		a += "X=" + n + ".00\nY=0.00\nZ=0.00\n";
+		break;
+	case SyntheticKind::AUDIO:
+		section(u8"音声ファイル");
+		a += u8"ファイル=C:\\audio\\" + n + ".wav\n";
+		section(u8"音声再生");
+		a += u8"音量=100.00\n左右=0.00\n";
+		break;
+	case SyntheticKind::FILTER_OBJECT:
+		section(u8"フィルタオブジェクト");
+		section(u8"色調補正");
+		a += u8"明るさ=" + n + "\n";
+		break;
+	case SyntheticKind::GROUP:
+		section(u8"グループ制御");
+		a += u8"X=0.00\n対象レイヤー数=" + std::to_string(index % 5 + 1) + "\n";
+		break;
+	}
+	for (int i = 0; i < filters; i++) {
+		section(i % 2 ? u8"ぼかし" : u8"グロー");
+		a += u8"範囲=" + std::to_string(i + index) + u8"\n縦横比=0.00\n光の強さ=" + n + "\n";
+	}
+	return a;
+}
+
+
+/// count 個のオブジェクトからなるタイムラインを合成する
+static std::vector<std::shared_ptr<const std::string>> make_timeline(size_t count) {
+	static const SyntheticKind KINDS[] = {
+		SyntheticKind::TEXT, SyntheticKind::TEXT, SyntheticKind::AUDIO, SyntheticKind::FILTER_OBJECT, SyntheticKind::GROUP
+	};
+	std::vector<std::shared_ptr<const std::string>> timeline;
+	timeline.reserve(count);
+	for (size_t i = 0; i < count; i++) {
+		const SyntheticKind kind = KINDS[i % (sizeof(KINDS) / sizeof(KINDS[0]))];
+		const int filters = (int)(i % 8);
+		const size_t text_size = i % 64 == 0 ? 4096 : 16;
+		timeline.push_back(std::make_shared<const std::string>(make_alias(kind, (int)i, filters, text_size)));
+	}
+	return timeline;
+}
+
+
+/// 各コマンドが作成するエイリアスを組み立てて built に追加する
+/// (コマンドと同じく、作成したエイリアスは適用が終わるまで保持する)
+static void build_all(const SplitPlan& plan, std::vector<std::shared_ptr<const std::string>>& built) {
+	built.push_back(build_source_alias(plan));
+	built.push_back(build_target_alias(plan));
+	for (int i = 0; i < plan.filter_count(); i++) {
+		built.push_back(build_single_filter_alias(plan, plan.start_index + i));
+	}
+	built.push_back(build_group_alias(plan, false));
+	built.push_back(build_remaining_alias(plan, plan.filter_count() / 2));
+}
+
+
+static double elapsed_ms(std::chrono::steady_clock::time_point start) {
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+
+int main(int argc, char** argv) {
+	const size_t count = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 10000;
+	const int iterations = argc > 2 ? std::max(1, std::atoi(argv[2])) : 5;
+
+	const auto timeline = make_timeline(count);
+	size_t bytes = 0;
+	for (const auto& alias : timeline) bytes += alias->size();
+	std::printf("objects=%zu bytes=%zu iterations=%d\n", count, bytes, iterations);
+	std::printf("%-12s %12s %12s %12s\n", "stage", "total ms", "ns/object", "MB/s");
+
+	auto report = [&](const char* stage, double ms, size_t stage_bytes) {
+		std::printf("%-12s %12.2f %12.1f %12.1f\n", stage, ms / iterations, ms * 1e6 / iterations / count,
+			stage_bytes / 1e6 * iterations / (ms / 1e3));
+	};
+
+	// キャッシュに当たらない解析 (毎回キャッシュの上限より多くのエイリアスを解析する)
+	std::vector<SplitPlan> plans(count);
+	double parse_ms = 0.0;
+	for (int it = 0; it < iterations; it++) {
+		auto start = std::chrono::steady_clock::now();
+		for (size_t i = 0; i < count; i++) plans[i] = make_split_plan(timeline[i]);
+		alias_cache().flush_staged();
+		parse_ms += elapsed_ms(start);
+	}
+	report("parse", parse_ms, bytes);
+
+	// キャッシュに収まる数ずつ解析し直す (2回目はキャッシュに当たる)
+	const size_t block = ALIAS_CACHE_MAX_ENTRIES / 2;
+	double cached_ms = 0.0;
+	for (int it = 0; it < iterations; it++) {
+		for (size_t first = 0; first < count; first += block) {
+			const size_t last = std::min(count, first + block);
+			for (size_t i = first; i < last; i++) plans[i] = make_split_plan(timeline[i]);
+			alias_cache().flush_staged();
+			auto start = std::chrono::steady_clock::now();
+			for (size_t i = first; i < last; i++) plans[i] = make_split_plan(timeline[i]);
+			cached_ms += elapsed_ms(start);
+		}
+	}
+	report("parse-cached", cached_ms, bytes);
+
+	// セクションのパラメータを引く (最初の参照で索引を作成し、2回目は索引だけを引く)
+	double params_ms = 0.0;
+	size_t found = 0;
+	for (int it = 0; it < iterations; it++) {
+		for (size_t i = 0; i < count; i++) plans[i] = make_split_plan(timeline[i]);
+		alias_cache().flush_staged();
+		auto start = std::chrono::steady_clock::now();
+		for (const auto& plan : plans) {
+			const auto& model = *plan.model;
+			for (size_t s = 0; s < model.parsed.objs.size(); s++) {
+				found += !model.param(s, "effect.name").empty();
+				found += !model.param(s, u8"範囲").empty();
+			}
+		}
+		params_ms += elapsed_ms(start);
+	}
+	report("params", params_ms, bytes);
+
+	double build_ms = 0.0;
+	size_t built_bytes = 0;
+	for (int it = 0; it < iterations; it++) {
+		std::vector<std::shared_ptr<const std::string>> built;
+		auto start = std::chrono::steady_clock::now();
+		for (const auto& plan : plans) build_all(plan, built);
+		alias_cache().flush_staged();
+		build_ms += elapsed_ms(start);
+
+		built_bytes = 0;
+		for (const auto& alias : built) built_bytes += alias->size();
+	}
+	report("build", build_ms, built_bytes);
+
+	// コマンドの並列段階と同じく、オブジェクトごとに解析して組み立てる
+	std::printf("%-12s %12s %12s %12s\n", "threads", "total ms", "ns/object", "speedup");
+	double single_ms = 0.0;
+	for (unsigned int threads : { 1u, 2u, 4u, 8u }) {
+		double ms = 0.0;
+		for (int it = 0; it < iterations; it++) {
+			std::vector<std::vector<std::shared_ptr<const std::string>>> built(count);
+			auto start = std::chrono::steady_clock::now();
+			parallel_for(count, [&](size_t i) {
+				build_all(make_split_plan(timeline[i]), built[i]);
+			}, threads);
+			alias_cache().flush_staged();
+			ms += elapsed_ms(start);
+		}
+		if (threads == 1) single_ms = ms;
+		std::printf("%-12u %12.2f %12.1f %12.2f\n", threads, ms / iterations, ms * 1e6 / iterations / count, single_ms / ms);
+	}
+
+	std::printf("alias cache: hits=%llu lookups=%llu\n",
+		(unsigned long long)alias_cache().hits(), (unsigned long long)alias_cache().lookups());
+	return 0;
+}
@@ -0,0 +1,146 @@
+#include "alias.h"
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// --- エイリアス解析の単体テスト ---
+// parse_alias が返すセクションの範囲・インデックス・ヘッダ・本文・effect.name と、AliasModel のパラメータの索引を確かめる
+// for_each_line は 64 バイトずつまとめて改行を探すため、改行がブロックの境目にある場合も確かめる
+// 終了コード: 成功なら 0、失敗なら 1
+
+/// 失敗した確認の数
+static int g_failures = 0;
+
+/// 値が一致するか確かめる (一致しなければ出力して失敗を数える)
+static void expect_eq(const char* test, const char* what, std::string_view actual, std::string_view expected) {
+	if (actual == expected) return;
+	std::printf("FAILED %s: %s = \"%.*s\" (expected \"%.*s\")\n", test, what,
+		(int)actual.size(), actual.data(), (int)expected.size(), expected.data());
+	g_failures++;
+}
+
+static void expect_eq(const char* test, const char* what, long long actual, long long expected) {
+	if (actual == expected) return;
+	std::printf("FAILED %s: %s = %lld (expected %lld)\n", test, what, actual, expected);
+	g_failures++;
+}
+
+
+/// 期待するセクション
+struct ExpectedSection {
+	int index;
+	std::string sec;
+	std::string_view effect_name;
+};
+
+/// alias を解析し、ヘッダとセクションを確かめる
+/// 各セクションの本文は、セクションの文字列から [Object.x] を除いたものとする
+static void check_parse(const char* test, const std::string& alias, std::string_view header, const std::vector<ExpectedSection>& expected) {
+	const ParsedAlias parsed = parse_alias(alias);
+	expect_eq(test, "header", parsed.header, header);
+	expect_eq(test, "sections", (long long)parsed.objs.size(), (long long)expected.size());
+	for (size_t i = 0; i < parsed.objs.size() && i < expected.size(); i++) {
+		const auto& sec = parsed.objs[i];
+		const auto& want = expected[i];
+		const std::string bracket = "[Object." + std::to_string(want.index) + "]";
+		expect_eq(test, "index", sec.index, want.index);
+		expect_eq(test, "sec", sec.sec, want.sec);
+		expect_eq(test, "body", sec.body, std::string_view(want.sec).substr(bracket.size()));
+		expect_eq(test, "effect_name", sec.effect_name, want.effect_name);
+		// 各範囲は解析元の文字列を参照する
+		expect_eq(test, "sec offset", sec.sec.data() - alias.data(), (long long)alias.find(want.sec));
+	}
+}
+
+
+/// 改行を nl にした、2つのセクションを持つエイリアス
+static void test_line_endings(const char* test, const std::string& nl) {
+	const std::string header = "[Object]" + nl + "layer=1" + nl + "frame=0,9" + nl;
+	const std::string sec0 = "[Object.0]" + nl + u8"effect.name=テキスト" + nl + u8"テキスト=a" + nl;
+	const std::string sec1 = "[Object.1]" + nl + u8"effect.name=標準描画" + nl + "X=0.00" + nl;
+	check_parse(test, header + sec0 + sec1, header, {
+		{ 0, sec0, u8"テキスト" },
+		{ 1, sec1, u8"標準描画" },
+	});
+}
+
+
+/// [Object] の次の行の改行を、64 バイトのブロックの nl_offset バイト目に置く
+static void test_block_boundary(const char* test, size_t nl_offset) {
+	const std::string head = "[Object]\n";
+	const std::string pad = "p=" + std::string(nl_offset - head.size() - 2, 'a') + "\n";
+	const std::string header = head + pad;
+	const std::string sec0 = u8"[Object.0]\neffect.name=図形\nサイズ=100\n";
+	const std::string sec1 = u8"[Object.1]\neffect.name=ぼかし\n範囲=" + std::string(64, '1') + "\n";
+	const std::string alias = header + sec0 + sec1;
+	expect_eq(test, "newline offset", (long long)alias.find('\n', head.size()), (long long)nl_offset);
+	check_parse(test, alias, header, {
+		{ 0, sec0, u8"図形" },
+		{ 1, sec1, u8"ぼかし" },
+	});
+}
+
+
+/// AliasModel::param でセクションのパラメータを引く
+static void test_params() {
+	const char* test = "params";
+	const auto plan = make_split_plan(std::make_shared<const std::string>(
+		u8"[Object]\r\n[Object.0]\r\neffect.name=グループ制御\r\n対象レイヤー数=3\r\nX=1.00\r\nX=2.00\r\n[Object.1]\r\neffect.name=ぼかし\r\n範囲=5"));
+	const AliasModel& model = *plan.model;
+	expect_eq(test, "sections", (long long)model.parsed.objs.size(), 2);
+	expect_eq(test, u8"対象レイヤー数", model.param(0, u8"対象レイヤー数"), "3");
+	expect_eq(test, "effect.name", model.param(1, "effect.name"), u8"ぼかし");
+	// 同じ key は最初のもの、改行で終わらない最終行も値にする
+	expect_eq(test, "X", model.param(0, "X"), "1.00");
+	expect_eq(test, u8"範囲", model.param(1, u8"範囲"), "5");
+	// ないものは空
+	expect_eq(test, "missing key", model.param(1, "X"), "");
+	expect_eq(test, "section out of range", model.param(2, "effect.name"), "");
+	expect_eq(test, "params out of range", (long long)model.params(100).size(), 0);
+}
+
+
+int main() {
+	test_line_endings("lf", "\n");
+	test_line_endings("crlf", "\r\n");
+	test_block_boundary("newline at byte 63", 63);
+	test_block_boundary("newline at byte 64", 64);
+	test_params();
+
+	// 改行で終わらない最終行
+	{
+		const std::string sec0 = u8"[Object.0]\neffect.name=図形\n";
+		const std::string sec1 = u8"[Object.1]\neffect.name=ぼかし";
+		check_parse("no trailing newline", "[Object]\n" + sec0 + sec1, "[Object]\n", {
+			{ 0, sec0, u8"図形" },
+			{ 1, sec1, u8"ぼかし" },
+		});
+	}
+
+	// x が数字でない [Object.x] は本文の行とみなす
+	{
+		const std::string sec0 = u8"[Object.0]\neffect.name=テキスト\n[Object.abc]\nテキスト=a\n" + std::string(64, 'b') + "\n";
+		const std::string sec1 = u8"[Object.1]\neffect.name=ぼかし\n";
+		check_parse("non-numeric section", "[Object]\n" + sec0 + sec1, "[Object]\n", {
+			{ 0, sec0, u8"テキスト" },
+			{ 1, sec1, u8"ぼかし" },
+		});
+	}
+
+	// 64 バイトより短い (スカラーでのみ探す)
+	{
+		const std::string sec0 = u8"[Object.0]\neffect.name=図形\n";
+		const std::string alias = "[Object]\n" + sec0;
+		expect_eq("short", "size < 64", alias.size() < 64, 1);
+		check_parse("short", alias, "[Object]\n", {
+			{ 0, sec0, u8"図形" },
+		});
+	}
+
+	if (g_failures) {
+		std::printf("%d checks failed\n", g_failures);
+		return 1;
+	}
+	std::printf("alias_test: all checks passed\n");
+	return 0;
+}
@@ -0,0 +1,174 @@
+#include "fake_host.h"
+#include "alloc_stats.h"
+#include <algorithm>
+#include <cassert>
+#include <iterator>
+
+/// 作成中の FakeHost
+static FakeHost* g_fake = nullptr;
+
+static FakeObject* to_object(OBJECT_HANDLE obj) {
+	return (FakeObject*)obj;
+}
+
+
+/// EDIT_SECTION の関数
+struct FakeHostAccess {
+	/// ホスト呼び出し1回分 (回数を数え、呼び出し中のヒープ確保はコマンドの計測から除く)
+	struct Call {
+		explicit Call(uint64_t& counter) : counting(alloc_stats_suspend()) { g_fake->on_call(counter); }
+		~Call() { alloc_stats_resume(counting); }
+		bool counting;
+	};
+
+	static OBJECT_HANDLE find_object(int layer, int frame) {
+		Call call(g_fake->counts.find_object);
+		auto it = g_fake->layers.find(layer);
+		if (it == g_fake->layers.end()) return nullptr;
+
+		// frame を含むオブジェクト、なければ frame より後の最初のオブジェクト
+		const auto& row = it->second;
+		auto next = row.upper_bound(frame);
+		if (next != row.begin() && std::prev(next)->second->end >= frame) return std::prev(next)->second;
+		return next == row.end() ? nullptr : next->second;
+	}
+
+	static OBJECT_LAYER_FRAME get_object_layer_frame(OBJECT_HANDLE obj) {
+		Call call(g_fake->counts.get_layer_frame);
+		auto object = to_object(obj);
+		if (!object || !object->alive) return {};
+		return { object->layer, object->start, object->end };
+	}
+
+	static LPCSTR get_object_alias(OBJECT_HANDLE obj) {
+		Call call(g_fake->counts.get_alias);
+		auto object = to_object(obj);
+		if (!object || !object->alive) return nullptr;
+		return object->alias.c_str();
+	}
+
+	static OBJECT_HANDLE create_object_from_alias(LPCSTR alias, int layer, int frame, int length) {
+		Call call(g_fake->counts.create_object);
+		if (!alias || (g_fake->accept && !g_fake->accept(alias))) return nullptr;
+		return g_fake->put(layer, frame, frame + length, alias);
+	}
+
+	static void delete_object(OBJECT_HANDLE obj) {
+		Call call(g_fake->counts.delete_object);
+		auto object = to_object(obj);
+		if (!object || !object->alive) return;
+		g_fake->layers[object->layer].erase(object->start);
+		object->alive = false;
+		if (g_fake->focus == object) g_fake->focus = nullptr;
+	}
+
+	static OBJECT_HANDLE get_focus_object() {
+		Call call(g_fake->counts.other);
+		return g_fake->focus;
+	}
+
+	static void set_focus_object(OBJECT_HANDLE obj) {
+		Call call(g_fake->counts.other);
+		g_fake->focus = to_object(obj);
+	}
+
+	static OBJECT_HANDLE get_selected_object(int index) {
+		Call call(g_fake->counts.other);
+		if (index < 0 || index >= (int)g_fake->selection.size()) return nullptr;
+		return g_fake->selection[index];
+	}
+
+	static int get_selected_object_num() {
+		Call call(g_fake->counts.other);
+		return (int)g_fake->selection.size();
+	}
+
+	static void set_object_name(OBJECT_HANDLE, LPCWSTR) {
+		Call call(g_fake->counts.other);
+	}
+};
+
+
+FakeHost::FakeHost() : info(), section() {
+	assert(!g_fake);
+	info.layer_max = -1;
+	info.select_range_start = info.select_range_end = -1;
+	section.info = &info;
+	section.find_object = FakeHostAccess::find_object;
+	section.get_object_layer_frame = FakeHostAccess::get_object_layer_frame;
+	section.get_object_alias = FakeHostAccess::get_object_alias;
+	section.create_object_from_alias = FakeHostAccess::create_object_from_alias;
+	section.delete_object = FakeHostAccess::delete_object;
+	section.get_focus_object = FakeHostAccess::get_focus_object;
+	section.set_focus_object = FakeHostAccess::set_focus_object;
+	section.get_selected_object = FakeHostAccess::get_selected_object;
+	section.get_selected_object_num = FakeHostAccess::get_selected_object_num;
+	section.set_object_name = FakeHostAccess::set_object_name;
+	g_fake = this;
+}
+
+
+FakeHost::~FakeHost() {
+	g_fake = nullptr;
+}
+
+
+FakeObject* FakeHost::put(int layer, int start, int end, std::string alias) {
+	if (layer < 0 || start < 0 || end < start || overlaps(layer, start, end)) return nullptr;
+	objects.push_back(std::make_unique<FakeObject>(FakeObject{ layer, start, end, std::move(alias) }));
+	auto object = objects.back().get();
+	layers[layer][start] = object;
+	info.layer_max = std::max(info.layer_max, layer);
+	info.frame_max = std::max(info.frame_max, end);
+	return object;
+}
+
+
+FakeObject* FakeHost::object_at(int layer, int frame) const {
+	auto it = layers.find(layer);
+	if (it == layers.end()) return nullptr;
+	auto next = it->second.upper_bound(frame);
+	if (next == it->second.begin()) return nullptr;
+	auto object = std::prev(next)->second;
+	return object->end >= frame ? object : nullptr;
+}
+
+
+std::vector<FakeObject*> FakeHost::objects_on(int layer) const {
+	std::vector<FakeObject*> result;
+	auto it = layers.find(layer);
+	if (it == layers.end()) return result;
+	for (const auto& entry : it->second) result.push_back(entry.second);
+	return result;
+}
+
+
+size_t FakeHost::object_count() const {
+	size_t count = 0;
+	for (const auto& row : layers) count += row.second.size();
+	return count;
+}
+
+
+void FakeHost::set_select_range(int start, int end) {
+	info.select_range_start = start;
+	info.select_range_end = end;
+}
+
+
+void FakeHost::on_call(uint64_t& counter) {
+	counter++;
+	if (call_latency.count() <= 0) return;
+	// スリープの精度では短い時間を待てないため、時刻を見ながら待つ
+	const auto until = std::chrono::steady_clock::now() + call_latency;
+	while (std::chrono::steady_clock::now() < until) {}
+}
+
+
+bool FakeHost::overlaps(int layer, int start, int end) const {
+	auto it = layers.find(layer);
+	if (it == layers.end()) return false;
+	const auto& row = it->second;
+	auto next = row.upper_bound(end);
+	return next != row.begin() && std::prev(next)->second->end >= start;
+}
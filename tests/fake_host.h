@@ -0,0 +1,88 @@
+#pragma once
+#include "host_api.h"
+#include <chrono>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+// --- テスト用のタイムライン ---
+// AviUtl2 なしでコマンドを実行するため、EDIT_SECTION の関数をメモリ上のタイムラインで実装する
+// レイヤーごとにオブジェクトを開始フレーム順に持ち、find_object・create_object_from_alias などは
+// AviUtl2 と同じくフレーム範囲が重なる配置を受け付けない
+// EDIT_SECTION の関数に状態を渡せないため、同時に作成できるのは1つだけ (TraceReplay と同じ)
+
+/// タイムライン上のオブジェクト
+struct FakeObject {
+	int layer;
+	int start;
+	int end;				// 最後のフレーム (end を含む)
+	std::string alias;
+	bool alive = true;		// 削除されたら false
+};
+
+/// FakeHost の関数ごとの呼び出し回数
+struct FakeHostCalls {
+	uint64_t find_object = 0;
+	uint64_t get_layer_frame = 0;
+	uint64_t get_alias = 0;
+	uint64_t create_object = 0;
+	uint64_t delete_object = 0;
+	uint64_t other = 0;		// フォーカス・選択・オブジェクト名
+
+	uint64_t total() const {
+		return find_object + get_layer_frame + get_alias + create_object + delete_object + other;
+	}
+};
+
+class FakeHost {
+public:
+	FakeHost();
+	~FakeHost();
+	FakeHost(const FakeHost&) = delete;
+	FakeHost& operator=(const FakeHost&) = delete;
+
+	EDIT_SECTION* edit() { return &section; }
+
+	/// オブジェクトを配置する (重なる場合は nullptr)
+	FakeObject* put(int layer, int start, int end, std::string alias);
+	/// 指定レイヤーの frame を含むオブジェクト (なければ nullptr)
+	FakeObject* object_at(int layer, int frame) const;
+	/// 指定レイヤーのオブジェクト (開始フレーム順)
+	std::vector<FakeObject*> objects_on(int layer) const;
+	/// タイムライン上のオブジェクトの数
+	size_t object_count() const;
+
+	/// 選択中オブジェクトを設定する
+	void select(std::vector<FakeObject*> objects) { selection = std::move(objects); }
+	/// フォーカス中のオブジェクトを設定する
+	void set_focus(FakeObject* object) { focus = object; }
+	FakeObject* focused() const { return focus; }
+
+	/// 選択範囲のフレーム (EDIT_INFO::select_range_start / end)
+	void set_select_range(int start, int end);
+
+	/// 1回のホスト呼び出しにかかる時間 (AviUtl2 の呼び出しの重さを模擬する、既定は 0)
+	void set_latency(std::chrono::nanoseconds latency) { call_latency = latency; }
+
+	/// 作成を受け付けるエイリアスの条件 (false を返すと create_object_from_alias が失敗する、既定はすべて受け付ける)
+	std::function<bool(const char* alias)> accept;
+
+	const FakeHostCalls& calls() const { return counts; }
+	void reset_calls() { counts = {}; }
+
+private:
+	friend struct FakeHostAccess;
+	void on_call(uint64_t& counter);
+	bool overlaps(int layer, int start, int end) const;
+
+	EDIT_INFO info;
+	EDIT_SECTION section;
+	std::vector<std::unique_ptr<FakeObject>> objects;		// 削除したものも含めて保持する (ハンドルを無効にしない)
+	std::map<int, std::map<int, FakeObject*>> layers;		// レイヤー -> 開始フレーム -> オブジェクト
+	std::vector<FakeObject*> selection;
+	FakeObject* focus = nullptr;
+	std::chrono::nanoseconds call_latency{ 0 };
+	FakeHostCalls counts;
+};
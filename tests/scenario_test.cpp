@@ -0,0 +1,526 @@
+#include "fake_host.h"
+#include "commands.h"
+#include "compat.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+
+// --- コマンドのシナリオテスト ---
+// FakeHost のタイムラインにオブジェクトを並べてコマンドを実行し、結果のオブジェクト数と
+// 各オブジェクトのエフェクト名の並び、ホスト呼び出しとヒープ確保の回数を確かめる (コマンドごとの予算 COMMAND_BUDGETS を超えたら失敗にする)
+// ヒープ確保は SPLIT_FILTERS_ALLOC_STATS を定義してビルドした場合のみ確かめる
+// シナリオ名 match_from_focus は、フォーカス中のオブジェクトから設定した条件で指定フィルタのみを分離できるかを確かめる
+// シナリオ名 object_menu_scope は、オブジェクトメニューから実行したコマンドが対象範囲によらず選択中オブジェクトだけを処理するかを確かめる
+// シナリオ名 attach_learning は、結合先が受け付けないフィルタ効果を ATTACH_REJECT_FAILURES 回の失敗で記録し、リセットで消せるかを確かめる
+// シナリオ名 batch.<シナリオ名> は、区切りを同期して実行する EDIT_HANDLE で分割実行し、最後まで実行した結果を確かめる
+// シナリオ名 batch_cancel.<シナリオ名> は、2つ目の区切りの後で「分割実行を中止」し、処理済みの対象だけが変更されたかを確かめる
+// シナリオ名 trace_replay は、すべてのシナリオを記録してから replay_command で再生し、記録どおりに再生できるかを確かめる
+// 使い方: scenario_test <シナリオ名> [オブジェクト数] [1回のホスト呼び出しにかかる時間 (マイクロ秒)]
+// 終了コード: 成功なら 0、失敗なら 1
+
+/// 出力されたログの数
+static size_t g_warnings = 0;
+/// 最後に出力された info ログ (UTF-8)
+static std::string g_last_info;
+
+static void log_to_stderr(const char* level, LPCWSTR message) {
+	std::fprintf(stderr, "[%s] %s\n", level, wide_to_utf8(message).c_str());
+}
+
+static LOG_HANDLE g_test_logger = {
+	[](LOG_HANDLE*, LPCWSTR message) { log_to_stderr("log", message); },
+	[](LOG_HANDLE*, LPCWSTR message) { g_last_info = wide_to_utf8(message); log_to_stderr("info", message); },
+	[](LOG_HANDLE*, LPCWSTR message) { g_warnings++; log_to_stderr("warn", message); },
+	[](LOG_HANDLE*, LPCWSTR message) { g_warnings++; log_to_stderr("error", message); },
+	[](LOG_HANDLE*, LPCWSTR) {},
+};
+
+static CONFIG_HANDLE g_identity_config = {
+	L"",
+	[](CONFIG_HANDLE*, LPCWSTR text) { return text; },
+};
+
+
+/// 1オブジェクト分のエイリアスを作成する
+/// @param effect_name オブジェクトの種類のエフェクト名
+/// @param filters 追加フィルタ効果のエフェクト名
+/// @param drawing 標準描画を含めるか (メディアオブジェクトのみ)
+static std::string make_alias(const char* effect_name, std::initializer_list<const char*> filters, bool drawing = true) {
+	std::string a = "[Object]\r\n";
+	int sec = 0;
+	auto section = [&](const char* name, const char* items) {
+		a += "[Object." + std::to_string(sec++) + "]\r\neffect.name=" + name + "\r\n" + items;
+	};
+	section(effect_name, "v=1\r\n");
+	if (drawing) section(u8"標準描画", "X=0.00\r\nY=0.00\r\n");
+	for (const char* filter : filters) section(filter, u8"強さ=10\r\n");
+	return a;
+}
+
+
+/// 格子状にオブジェクトを並べる
+/// rows 行 (1行に stride レイヤーを使う) に、左から 100 フレームずつ並べる
+/// @param count オブジェクト数
+/// @param put_one 1つ分を配置する (レイヤー, 開始フレーム, 終了フレーム)
+template<typename F>
+static void fill_grid(size_t count, int stride, F put_one) {
+	const size_t rows = 50;
+	for (size_t i = 0; i < count; i++) {
+		const int layer = (int)(i % rows) * stride;
+		const int start = (int)(i / rows) * 100;
+		put_one(layer, start, start + 89);
+	}
+}
+
+
+/// シナリオ
+struct Scenario {
+	const char* name;
+	void (__cdecl *command)(EDIT_SECTION*);
+	/// タイムラインを作成し、選択・フォーカスを設定する
+	void (*setup)(FakeHost& host, size_t count);
+	/// コマンド後のオブジェクト数
+	size_t (*expected_objects)(size_t count);
+	/// コマンド後の各オブジェクトのエフェクト名の並び ([Object.0] から順に、いずれかに一致すること)
+	std::vector<std::vector<std::string_view>> shapes;
+	/// コマンド後のグループ制御の対象レイヤー数
+	int group_layers = 1;
+};
+
+static const Scenario SCENARIOS[] = {
+	{ "split_filters", split_filters_callback,
+		[](FakeHost& host, size_t count) {
+			std::vector<FakeObject*> selection;
+			fill_grid(count, 2, [&](int layer, int start, int end) {
+				selection.push_back(host.put(layer, start, end, make_alias(u8"テキスト", { u8"ぼかし", u8"縁取り" })));
+			});
+			host.select(std::move(selection));
+		},
+		[](size_t count) { return count * 2; },
+		{ { u8"テキスト", u8"標準描画" }, { u8"ぼかし", u8"縁取り" } } },
+	{ "split_matching_filters", split_matching_filters_callback,
+		[](FakeHost& host, size_t count) {
+			g_split_match = EffectNameFilter(u8"ぼかし");
+			std::vector<FakeObject*> selection;
+			fill_grid(count, 2, [&](int layer, int start, int end) {
+				selection.push_back(host.put(layer, start, end, make_alias(u8"テキスト", { u8"ぼかし", u8"縁取り" })));
+			});
+			host.select(std::move(selection));
+		},
+		[](size_t count) { return count * 2; },
+		{ { u8"テキスト", u8"標準描画", u8"縁取り" }, { u8"ぼかし" } } },
+	{ "split_filters_for_group", split_filters_for_group_callback,
+		[](FakeHost& host, size_t count) {
+			std::vector<FakeObject*> selection;
+			fill_grid(count, 2, [&](int layer, int start, int end) {
+				selection.push_back(host.put(layer, start, end, make_alias(u8"図形", { u8"ぼかし", u8"縁取り" })));
+			});
+			host.select(std::move(selection));
+		},
+		[](size_t count) { return count * 2; },
+		{ { u8"図形", u8"標準描画" }, { u8"グループ制御", u8"ぼかし", u8"縁取り" } } },
+	{ "split_filters_for_shared_group", split_filters_for_shared_group_callback,
+		[](FakeHost& host, size_t count) {
+			// 隣り合う2レイヤーで末尾のフィルタ効果が共通する組を並べる (組ごとにグループ制御を1つ作る)
+			std::vector<FakeObject*> selection;
+			fill_grid(count / 2, 3, [&](int layer, int start, int end) {
+				selection.push_back(host.put(layer, start, end, make_alias(u8"図形", { u8"発光", u8"ぼかし", u8"縁取り" })));
+				selection.push_back(host.put(layer + 1, start, end, make_alias(u8"テキスト", { u8"ぼかし", u8"縁取り" })));
+			});
+			host.select(std::move(selection));
+		},
+		[](size_t count) { return count / 2 * 3; },
+		// 先頭の 発光 は共通でないため元のオブジェクトに残る
+		{ { u8"図形", u8"標準描画", u8"発光" }, { u8"テキスト", u8"標準描画" }, { u8"グループ制御", u8"ぼかし", u8"縁取り" } }, 2 },
+	{ "explode_filters", explode_filters_callback,
+		[](FakeHost& host, size_t count) {
+			std::vector<FakeObject*> selection;
+			fill_grid(count, 3, [&](int layer, int start, int end) {
+				selection.push_back(host.put(layer, start, end, make_alias(u8"テキスト", { u8"ぼかし", u8"縁取り" })));
+			});
+			host.select(std::move(selection));
+		},
+		[](size_t count) { return count * 3; },
+		// フィルタ効果オブジェクトにはフィルタ効果を1つずつ
+		{ { u8"テキスト", u8"標準描画" }, { u8"ぼかし" }, { u8"縁取り" } } },
+	{ "merge_filters", merge_filters_callback,
+		[](FakeHost& host, size_t count) {
+			// 下のフィルタオブジェクトを選択し、上のメディアオブジェクトに結合する
+			std::vector<FakeObject*> selection;
+			fill_grid(count / 2, 2, [&](int layer, int start, int end) {
+				host.put(layer, start, end, make_alias(u8"テキスト", { u8"ぼかし" }));
+				selection.push_back(host.put(layer + 1, start, end, make_alias(u8"フィルタオブジェクト", { u8"縁取り", u8"発光" }, false)));
+			});
+			host.select(std::move(selection));
+		},
+		[](size_t count) { return count / 2; },
+		{ { u8"テキスト", u8"標準描画", u8"ぼかし", u8"縁取り", u8"発光" } } },
+	{ "merge_head_filters", merge_head_filters_callback,
+		[](FakeHost& host, size_t count) {
+			std::vector<FakeObject*> selection;
+			fill_grid(count / 2, 2, [&](int layer, int start, int end) {
+				host.put(layer, start, end, make_alias(u8"テキスト", { u8"ぼかし" }));
+				selection.push_back(host.put(layer + 1, start, end, make_alias(u8"フィルタオブジェクト", { u8"縁取り", u8"発光" }, false)));
+			});
+			host.select(std::move(selection));
+		},
+		[](size_t count) { return count / 2 * 2; },
+		{ { u8"テキスト", u8"標準描画", u8"ぼかし", u8"縁取り" }, { u8"フィルタオブジェクト", u8"発光" } } },
+	{ "broadcast_append_filters", broadcast_append_filters_callback,
+		[](FakeHost& host, size_t count) {
+			std::vector<FakeObject*> selection;
+			fill_grid(count, 1, [&](int layer, int start, int end) {
+				selection.push_back(host.put(layer, start, end, make_alias(u8"テキスト", { u8"ぼかし" })));
+			});
+			host.set_focus(selection.front());
+			selection.front()->alias = make_alias(u8"テキスト", { u8"縁取り", u8"発光" });
+			host.select(std::move(selection));
+		},
+		[](size_t count) { return count; },
+		{ { u8"テキスト", u8"標準描画", u8"ぼかし", u8"縁取り", u8"発光" }, { u8"テキスト", u8"標準描画", u8"縁取り", u8"発光" } } },
+	{ "broadcast_replace_filters", broadcast_replace_filters_callback,
+		[](FakeHost& host, size_t count) {
+			std::vector<FakeObject*> selection;
+			fill_grid(count, 1, [&](int layer, int start, int end) {
+				selection.push_back(host.put(layer, start, end, make_alias(u8"テキスト", { u8"ぼかし" })));
+			});
+			host.set_focus(selection.front());
+			selection.front()->alias = make_alias(u8"テキスト", { u8"縁取り", u8"発光" });
+			host.select(std::move(selection));
+		},
+		[](size_t count) { return count; },
+		{ { u8"テキスト", u8"標準描画", u8"縁取り", u8"発光" } } },
+	{ "collapse_filters", collapse_filters_callback,
+		[](FakeHost& host, size_t count) {
+			// 同じフレーム範囲で連続する2つのフィルタオブジェクトを1つにまとめる
+			std::vector<FakeObject*> selection;
+			fill_grid(count / 2, 3, [&](int layer, int start, int end) {
+				selection.push_back(host.put(layer, start, end, make_alias(u8"フィルタオブジェクト", { u8"ぼかし" }, false)));
+				host.put(layer + 1, start, end, make_alias(u8"フィルタオブジェクト", { u8"縁取り" }, false));
+			});
+			host.select(std::move(selection));
+		},
+		[](size_t count) { return count / 2; },
+		// 上のフィルタオブジェクトのフィルタ効果から順に並ぶ
+		{ { u8"フィルタオブジェクト", u8"ぼかし", u8"縁取り" } } },
+};
+
+
+/// タイムラインのオブジェクトのうち、エフェクト名の並びかグループ制御の対象レイヤー数がシナリオと異なるものを数える
+/// (最初の1つのエイリアスと、異なるものの数を出力する)
+static size_t count_unexpected_aliases(FakeHost& host, const Scenario& scenario) {
+	size_t unexpected = 0;
+	for (int layer = 0; layer <= host.edit()->info->layer_max; layer++) {
+		for (const auto object : host.objects_on(layer)) {
+			const auto plan = make_split_plan(std::make_shared<const std::string>(object->alias));
+			std::vector<std::string_view> names;
+			for (const auto& sec : plan.parsed().objs) names.push_back(sec.effect_name);
+			bool shaped = std::find(scenario.shapes.begin(), scenario.shapes.end(), names) != scenario.shapes.end();
+			if (shaped && names[0] == std::string_view(u8"グループ制御")) {
+				shaped = plan.model->param(0, u8"対象レイヤー数") == std::to_string(scenario.group_layers);
+			}
+			if (!shaped && unexpected++ == 0) std::printf("  unexpected alias at L%d:%d:\n%s\n", layer, object->start, object->alias.c_str());
+		}
+	}
+	if (unexpected) std::printf("  unexpected aliases: %zu\n", unexpected);
+	return unexpected;
+}
+
+
+/// シナリオを実行して結果を確かめる
+/// @return 成功したか
+static bool run_scenario(const Scenario& scenario, size_t count, int latency_us) {
+	FakeHost host;
+	host.set_latency(std::chrono::microseconds(latency_us));
+	scenario.setup(host, count);
+	host.reset_calls();
+
+	const auto start = std::chrono::steady_clock::now();
+	scenario.command(host.edit());
+	const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+	const CommandStats& stats = last_command_stats();
+	const size_t objects = host.object_count();
+	const size_t expected = scenario.expected_objects(count);
+	std::printf("%s: objects=%zu targets=%zu host calls=%u budget=%llu time=%.1fms\n", scenario.name, count, stats.targets,
+		stats.host_calls.total(), (unsigned long long)stats.host_call_budget, ms);
+	if (alloc_stats_available()) {
+		std::printf("  heap allocs=%llu budget=%llu bytes=%llu peak=%llu\n", (unsigned long long)stats.allocs.count,
+			(unsigned long long)stats.alloc_budget, (unsigned long long)stats.allocs.bytes, (unsigned long long)stats.allocs.peak_bytes);
+	}
+
+	bool ok = true;
+	auto fail = [&](const char* what) {
+		std::printf("FAILED: %s\n", what);
+		ok = false;
+	};
+	if (!stats.command || std::strcmp(stats.command, scenario.name) != 0) fail("command did not run");
+	if (stats.host_calls.total() > stats.host_call_budget) fail("host calls over budget");
+	if (alloc_stats_available() && stats.allocs.count > stats.alloc_budget) fail("heap allocations over budget");
+	// ホスト呼び出しがすべて host.h を通っているか
+	if (stats.host_calls.total() != host.calls().total()) fail("host calls not counted by host.h");
+	if (objects != expected) {
+		std::printf("  objects after command: %zu (expected %zu)\n", objects, expected);
+		fail("unexpected timeline");
+	}
+	if (count_unexpected_aliases(host, scenario)) fail("unexpected aliases");
+	if (g_warnings) fail("command reported failures");
+	return ok;
+}
+
+
+/// 分割実行の区切りを実行する FakeHost
+static FakeHost* g_sync_host = nullptr;
+
+/// 編集処理をその場で実行する EDIT_HANDLE (分割実行の区切りを run_deferred_call から同期して実行する)
+static EDIT_HANDLE g_sync_edit_handle = {
+	[](void (*func_proc_edit)(EDIT_SECTION*)) { func_proc_edit(g_sync_host->edit()); return true; },
+	[](void* param, void (*func_proc_edit)(void*, EDIT_SECTION*)) { func_proc_edit(param, g_sync_host->edit()); return true; },
+};
+
+
+/// シナリオを分割実行し、予約された区切りをすべて実行してから結果を確かめる
+/// @param cancel_after 予約された区切りをこの数だけ実行したら「分割実行を中止」する (0 なら最後まで実行する)
+/// 中止した場合は、処理済みの対象だけが変更され、残りは元のままであることを確かめる (1対象ずつ独立に変更するシナリオのみ)
+/// @return 成功したか
+static bool run_batched_scenario(const Scenario& scenario, size_t count, size_t cancel_after) {
+	FakeHost host;
+	scenario.setup(host, count);
+	g_sync_host = &host;
+	edit_handle = &g_sync_edit_handle;
+
+	scenario.command(host.edit());
+	size_t rounds = 0;
+	bool cancelled = false;
+	while (run_deferred_call()) {
+		if (++rounds == cancel_after) {
+			cancel_batch_callback(host.edit());
+			cancelled = true;
+			break;
+		}
+	}
+	// 中止した後は区切りが残っていない
+	const bool pending = run_deferred_call();
+	edit_handle = nullptr;
+	g_sync_host = nullptr;
+
+	bool ok = true;
+	auto fail = [&](const char* what) {
+		std::printf("FAILED: %s\n", what);
+		ok = false;
+	};
+	const CommandStats& stats = last_command_stats();
+	const size_t objects = host.object_count();
+	if (!stats.command || std::strcmp(stats.command, scenario.name) != 0) fail("command did not run");
+	if (rounds == 0) fail("command did not run in chunks");
+	if (pending) fail("chunk scheduled after cancel");
+
+	if (!cancelled) {
+		const size_t expected = scenario.expected_objects(count);
+		std::printf("batch.%s: objects=%zu chunks=%zu after=%zu\n", scenario.name, count, rounds + 1, objects);
+		if (objects != expected) {
+			std::printf("  objects after batch: %zu (expected %zu)\n", objects, expected);
+			fail("unexpected timeline");
+		}
+		if (count_unexpected_aliases(host, scenario)) fail("unexpected aliases");
+	}
+	else {
+		// 中止のログの処理済みの数
+		size_t done = 0, total = 0;
+		const size_t paren = g_last_info.rfind('(');
+		if (paren == std::string::npos || std::sscanf(g_last_info.c_str() + paren, "(%zu / %zu", &done, &total) != 2) fail("no cancel message");
+		const size_t expected = scenario.expected_objects(done) + (count - done);
+		std::printf("batch_cancel.%s: objects=%zu chunks=%zu done=%zu/%zu after=%zu\n", scenario.name, count, rounds + 1, done, total, objects);
+		if (total != count || done == 0 || done >= count) fail("cancel did not stop mid-run");
+		if (objects != expected) {
+			std::printf("  objects after cancel: %zu (expected %zu)\n", objects, expected);
+			fail("unexpected timeline");
+		}
+	}
+	if (g_warnings) fail("command reported failures");
+	return ok;
+}
+
+
+/// 対象範囲を「シーン全体」にして、オブジェクトメニューからは選択中オブジェクトだけ、編集メニューからはすべてを処理するか確かめる
+/// @return 成功したか
+static bool run_object_menu_scope(size_t count) {
+	FakeHost host;
+	std::vector<FakeObject*> objects;
+	fill_grid(count, 2, [&](int layer, int start, int end) {
+		objects.push_back(host.put(layer, start, end, make_alias(u8"テキスト", { u8"ぼかし" })));
+	});
+	host.select({ objects.front() });
+
+	scope_scene_callback(host.edit());
+	object_menu<split_filters_callback>(host.edit());
+	const size_t from_object_menu = host.object_count();
+	split_filters_callback(host.edit());
+	const size_t from_edit_menu = host.object_count();
+	scope_selection_callback(host.edit());
+
+	std::printf("object_menu_scope: objects=%zu after object menu=%zu after edit menu=%zu\n", count, from_object_menu, from_edit_menu);
+	// 編集メニューでは、先に分離したフィルタ効果オブジェクトと元オブジェクトは分離するものがなく読み飛ばす
+	if (from_object_menu != count + 1 || from_edit_menu != count * 2) {
+		std::printf("FAILED: unexpected timeline\n");
+		return false;
+	}
+	return true;
+}
+
+
+/// フォーカス中のオブジェクトから設定した条件で「フィルタ分離（指定フィルタのみ）」を実行できるか確かめる
+/// @return 成功したか
+static bool run_match_from_focus(size_t count) {
+	FakeHost host;
+	std::vector<FakeObject*> selection;
+	fill_grid(count, 2, [&](int layer, int start, int end) {
+		selection.push_back(host.put(layer, start, end, make_alias(u8"テキスト", { u8"ぼかし", u8"縁取り", u8"発光" })));
+	});
+	host.set_focus(host.put(1, 0, 89, make_alias(u8"図形", { u8"発光", u8"ぼかし", u8"発光" })));
+	host.select(std::move(selection));
+
+	set_match_from_focus_callback(host.edit());
+	const std::string patterns(g_split_match.patterns());
+	split_matching_filters_callback(host.edit());
+
+	// 分離したフィルタ効果オブジェクトにだけ、一致したフィルタ効果が含まれる
+	size_t separated = 0;
+	for (int layer = 0; layer <= host.edit()->info->layer_max; layer++) {
+		for (const auto object : host.objects_on(layer)) {
+			if (object->alias.find(u8"effect.name=ぼかし") != std::string::npos && object->alias.find(u8"effect.name=縁取り") == std::string::npos) separated++;
+		}
+	}
+	std::printf("match_from_focus: patterns=%s objects=%zu separated=%zu\n", patterns.c_str(), host.object_count(), separated);
+	if (patterns != u8"発光;ぼかし" || separated != count + 1) {
+		std::printf("FAILED: unexpected timeline\n");
+		return false;
+	}
+	return true;
+}
+
+
+/// 一括追加で、ホストが受け付けないフィルタ効果を繰り返し失敗してから記録し、リセットで消せるか確かめる
+/// @return 成功したか
+static bool run_attach_learning(size_t count) {
+	FakeHost host;
+	std::vector<FakeObject*> selection;
+	fill_grid(count, 2, [&](int layer, int start, int end) {
+		selection.push_back(host.put(layer, start, end, make_alias(u8"テキスト", { u8"ぼかし" })));
+	});
+	host.set_focus(host.put(1, 0, 89, make_alias(u8"図形", { u8"発光" })));
+	host.select(selection);
+
+	// 一度だけ失敗した場合は記録せず、残りのオブジェクトには追加する
+	size_t rejected = 0;
+	host.accept = [&](const char* alias) {
+		if (rejected > 0 || !std::strstr(alias, u8"effect.name=発光")) return true;
+		rejected++;
+		return false;
+	};
+	broadcast_append_filters_callback(host.edit());
+
+	// 作成し直したオブジェクトを選択し直す
+	size_t transient_appended = 0;
+	selection.clear();
+	for (int layer = 0; layer <= host.edit()->info->layer_max; layer += 2) {
+		for (const auto object : host.objects_on(layer)) {
+			selection.push_back(object);
+			transient_appended += object->alias.find(u8"effect.name=発光") != std::string::npos;
+		}
+	}
+	host.select(std::move(selection));
+
+	// 受け付けない場合は ATTACH_REJECT_FAILURES 回だけ作成を試み、残りはホストを呼び出さずにスキップする
+	host.set_focus(host.put(1, 100, 189, make_alias(u8"図形", { u8"縁取り" })));
+	rejected = 0;
+	host.accept = [&](const char* alias) {
+		if (!std::strstr(alias, u8"effect.name=縁取り")) return true;
+		rejected++;
+		return false;
+	};
+	broadcast_replace_filters_callback(host.edit());
+	const size_t first_rejected = rejected;
+	broadcast_replace_filters_callback(host.edit());
+	const size_t learned_rejected = rejected - first_rejected;
+
+	// リセット後は、もう一度ホストに試す
+	reset_attach_table_callback(host.edit());
+	broadcast_replace_filters_callback(host.edit());
+	const size_t reset_rejected = rejected - first_rejected - learned_rejected;
+
+	std::printf("attach_learning: objects=%zu appended after one failure=%zu rejected=%zu/%zu/%zu\n",
+		count, transient_appended, first_rejected, learned_rejected, reset_rejected);
+	if (transient_appended != count - 1 || first_rejected != (size_t)ATTACH_REJECT_FAILURES
+		|| learned_rejected != 0 || reset_rejected != (size_t)ATTACH_REJECT_FAILURES) {
+		std::printf("FAILED: unexpected attach learning\n");
+		return false;
+	}
+	return true;
+}
+
+
+/// すべてのシナリオを記録してから再生し、記録どおりに再生できるかを確かめる
+/// @return 成功したか
+static bool run_trace_replay(size_t count) {
+	const auto path = std::filesystem::temp_directory_path() / "scenario_test.trace";
+	std::filesystem::remove(path);
+	trace_configure(path);
+	bool ok = true;
+	for (const auto& scenario : SCENARIOS) ok &= run_scenario(scenario, count, 0);
+	trace_configure({});
+
+	const auto commands = trace_load(path);
+	std::filesystem::remove(path);
+	if (commands.size() != sizeof(SCENARIOS) / sizeof(SCENARIOS[0])) {
+		std::printf("FAILED: %zu commands recorded\n", commands.size());
+		return false;
+	}
+	for (const auto& command : commands) {
+		TraceReplay replay(command);
+		const bool ran = replay_command(command, replay.edit());
+		const auto result = replay.result();
+		std::printf("replay %s: calls=%zu/%zu unused=%zu alias mismatches=%zu\n", command.name.c_str(),
+			result.calls, command.calls.size(), result.unused, result.alias_mismatches);
+		if (!ran || !result.matched()) {
+			std::printf("FAILED: replay diverged\n");
+			ok = false;
+		}
+	}
+	return ok;
+}
+
+
+int main(int argc, char** argv) {
+	if (argc < 2) {
+		std::fprintf(stderr, "usage: scenario_test <scenario> [objects] [latency us]\n");
+		return 1;
+	}
+	logger = &g_test_logger;
+	config = &g_identity_config;
+	// ヒープ確保は計測が有効なコマンドだけで数える
+	if (alloc_stats_available()) profile_configure(true, {});
+	const size_t count = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 10000;
+	const int latency_us = argc > 3 ? std::atoi(argv[3]) : 0;
+
+	if (std::strcmp(argv[1], "trace_replay") == 0) return run_trace_replay(count) ? 0 : 1;
+	if (std::strcmp(argv[1], "match_from_focus") == 0) return run_match_from_focus(count) ? 0 : 1;
+	if (std::strcmp(argv[1], "attach_learning") == 0) return run_attach_learning(count) ? 0 : 1;
+	if (std::strcmp(argv[1], "object_menu_scope") == 0) return run_object_menu_scope(count) ? 0 : 1;
+	// batch.<シナリオ名> は分割実行、batch_cancel.<シナリオ名> は2つ目の区切りの後で中止する
+	const std::string_view name = argv[1];
+	const std::string_view batch_prefix = "batch.", cancel_prefix = "batch_cancel.";
+	for (const auto& scenario : SCENARIOS) {
+		if (name == scenario.name) return run_scenario(scenario, count, latency_us) ? 0 : 1;
+		if (name.substr(0, batch_prefix.size()) == batch_prefix && name.substr(batch_prefix.size()) == scenario.name) {
+			return run_batched_scenario(scenario, count, 0) ? 0 : 1;
+		}
+		if (name.substr(0, cancel_prefix.size()) == cancel_prefix && name.substr(cancel_prefix.size()) == scenario.name) {
+			return run_batched_scenario(scenario, count, 2) ? 0 : 1;
+		}
+	}
+	std::fprintf(stderr, "unknown scenario: %s\n", argv[1]);
+	return 1;
+}
@@ -0,0 +1,10 @@
+#pragma once
+
+// --- AviUtl2 SDK (config2.h) の代わり ---
+// plugin2.h と同じく、このプラグインが使う関数だけを宣言する
+
+/// 設定ハンドル
+struct CONFIG_HANDLE {
+	LPCWSTR app_data_path;
+	LPCWSTR (*translate)(CONFIG_HANDLE* handle, LPCWSTR text);
+};
@@ -0,0 +1,13 @@
+#pragma once
+
+// --- AviUtl2 SDK (logger2.h) の代わり ---
+// plugin2.h と同じく、このプラグインが使う関数だけを宣言する
+
+/// ログ出力ハンドル
+struct LOG_HANDLE {
+	void (*log)(LOG_HANDLE* handle, LPCWSTR message);
+	void (*info)(LOG_HANDLE* handle, LPCWSTR message);
+	void (*warn)(LOG_HANDLE* handle, LPCWSTR message);
+	void (*error)(LOG_HANDLE* handle, LPCWSTR message);
+	void (*verbose)(LOG_HANDLE* handle, LPCWSTR message);
+};
@@ -0,0 +1,62 @@
+#pragma once
+
+// --- AviUtl2 SDK (plugin2.h) の代わり ---
+// Linux でテスト・記録の再生をビルドするため、このプラグインが使う型と関数だけを同じ順序で宣言する
+// Windows では SDK のサブモジュール (SplitFiltersPlugin/aviutl2_sdk) を使うこと
+// host_api.h から読み込む (Win32 の型は host_api.h で定義する)
+
+typedef void* OBJECT_HANDLE;
+
+/// オブジェクトのレイヤーとフレーム
+struct OBJECT_LAYER_FRAME {
+	int layer;
+	int start;
+	int end;
+};
+
+/// 編集情報
+struct EDIT_INFO {
+	int width, height;
+	int rate, scale;
+	int sample_rate;
+	int frame, layer;
+	int frame_max, layer_max;
+	int display_frame_start, display_layer_start;
+	int display_frame_num, display_layer_num;
+	int select_range_start, select_range_end;
+};
+
+/// 編集セクション
+struct EDIT_SECTION {
+	EDIT_INFO* info;
+	OBJECT_HANDLE (*create_object_from_alias)(LPCSTR alias, int layer, int frame, int length);
+	OBJECT_HANDLE (*find_object)(int layer, int frame);
+	int (*count_object_effect)(OBJECT_HANDLE object, LPCWSTR effect);
+	OBJECT_LAYER_FRAME (*get_object_layer_frame)(OBJECT_HANDLE object);
+	LPCSTR (*get_object_alias)(OBJECT_HANDLE object);
+	LPCSTR (*get_object_item_value)(OBJECT_HANDLE object, LPCWSTR effect, LPCWSTR item);
+	bool (*set_object_item_value)(OBJECT_HANDLE object, LPCWSTR effect, LPCWSTR item, LPCSTR value);
+	bool (*move_object)(OBJECT_HANDLE object, int layer, int frame);
+	void (*delete_object)(OBJECT_HANDLE object);
+	OBJECT_HANDLE (*get_focus_object)();
+	void (*set_focus_object)(OBJECT_HANDLE object);
+	LPCWSTR (*get_project_file)(void* edit_handle);
+	OBJECT_HANDLE (*get_selected_object)(int index);
+	int (*get_selected_object_num)();
+	LPCWSTR (*get_object_name)(OBJECT_HANDLE object);
+	void (*set_object_name)(OBJECT_HANDLE object, LPCWSTR name);
+};
+
+/// 編集ハンドル
+struct EDIT_HANDLE {
+	bool (*call_edit_section)(void (*func_proc_edit)(EDIT_SECTION* edit));
+	bool (*call_edit_section_param)(void* param, void (*func_proc_edit)(void* param, EDIT_SECTION* edit));
+};
+
+/// ホストアプリケーションの関数
+struct HOST_APP_TABLE {
+	void (*set_plugin_information)(LPCWSTR information);
+	void (*register_object_menu)(LPCWSTR name, void (*callback)(EDIT_SECTION* edit));
+	void (*register_edit_menu)(LPCWSTR name, void (*callback)(EDIT_SECTION* edit));
+	EDIT_HANDLE* (*create_edit_handle)();
+};
@@ -0,0 +1,61 @@
+#include "commands.h"
+#include <cstdio>
+
+// --- 記録の再生 ---
+// SPLIT_FILTERS_TRACE で記録したファイルのコマンドを、記録した順にプラグインの処理で再生し、
+// 記録どおりにホストを呼び出したか (作成したエイリアスが変わっていないか) をコマンドごとに出力する
+// 使い方: replay_trace <記録ファイル>
+// 終了コード: すべて記録どおりなら 0、異なるコマンドがあれば 1、読み込めなければ 2
+
+/// ログを標準エラー出力に出す
+static void log_to_stderr(const char* level, LPCWSTR message) {
+	std::fprintf(stderr, "[%s] %s\n", level, wide_to_utf8(message).c_str());
+}
+
+static LOG_HANDLE g_stderr_logger = {
+	[](LOG_HANDLE*, LPCWSTR message) { log_to_stderr("log", message); },
+	[](LOG_HANDLE*, LPCWSTR message) { log_to_stderr("info", message); },
+	[](LOG_HANDLE*, LPCWSTR message) { log_to_stderr("warn", message); },
+	[](LOG_HANDLE*, LPCWSTR message) { log_to_stderr("error", message); },
+	[](LOG_HANDLE*, LPCWSTR message) { log_to_stderr("verbose", message); },
+};
+
+/// 翻訳せずにそのまま返す
+static CONFIG_HANDLE g_identity_config = {
+	L"",
+	[](CONFIG_HANDLE*, LPCWSTR text) { return text; },
+};
+
+
+int main(int argc, char** argv) {
+	if (argc < 2) {
+		std::fprintf(stderr, "usage: replay_trace <trace file>\n");
+		return 2;
+	}
+	logger = &g_stderr_logger;
+	config = &g_identity_config;
+
+	const auto commands = trace_load(argv[1]);
+	if (commands.empty()) {
+		std::fprintf(stderr, "no commands: %s\n", argv[1]);
+		return 2;
+	}
+
+	size_t mismatched = 0;
+	std::printf("%-5s %-40s %8s %8s %8s %8s %s\n", "#", "command", "calls", "recorded", "unused", "aliases", "result");
+	for (size_t i = 0; i < commands.size(); i++) {
+		const auto& command = commands[i];
+		TraceReplay replay(command);
+		const bool ran = replay_command(command, replay.edit());
+		const auto result = replay.result();
+		const bool ok = ran && result.matched();
+		if (!ok) mismatched++;
+
+		std::printf("%-5zu %-40s %8zu %8zu %8zu %8zu %s", i, command.name.c_str(), result.calls, command.calls.size(),
+			result.unused, result.alias_mismatches, !ran ? "unknown command" : ok ? "ok" : "diverged");
+		if (result.diverged_at != SIZE_MAX) std::printf(" at %zu", result.diverged_at);
+		std::printf("\n");
+	}
+	std::printf("commands=%zu mismatched=%zu\n", commands.size(), mismatched);
+	return mismatched ? 1 : 0;
+}